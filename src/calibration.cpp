@@ -0,0 +1,330 @@
+/*
+ * Per-sensor calibration implementation
+ *
+ * The fit uses the mean of all sensors as the reference. Under uniform light they
+ * should all agree, so the fit maps each sensor onto that common scale. That removes the
+ * mismatch that would otherwise show up as a false gradient.
+ */
+
+#include <EEPROM.h>
+#include "calibration.h"
+#include "config.h"
+#include "crc16.h"
+
+SensorCalibration calibration;
+
+// Layout of the calibration block in EEPROM
+struct CalibrationRecord
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size; // sizeof(SensorCalibration), catches layout changes
+    SensorCalibration cal;
+    uint16_t crc; // CRC-16 of everything above
+};
+
+const uint32_t CAL_MAGIC = 0x4C41434C; // "LCAL"
+const uint16_t CAL_VERSION = 1;
+
+// Running least-squares sums for fitting y = c2*x^2 + c1*x + c0 for one sensor
+// (double precision: x^4 of a bright reading overflows a float's mantissa quickly)
+struct FitSums
+{
+    double n, x, x2, x3, x4, y, xy, x2y;
+    double xMin, xMax; // Range of the readings, for checking the fit is monotonic over it
+};
+
+// Determinants and variances below this fraction of their scale count as singular
+const double CAL_SINGULAR_TOLERANCE = 1e-6;
+
+void addSample(FitSums &s, double x, double y)
+{
+    if (s.n == 0 || x < s.xMin)
+    {
+        s.xMin = x;
+    }
+    if (s.n == 0 || x > s.xMax)
+    {
+        s.xMax = x;
+    }
+    s.n += 1;
+    s.x += x;
+    s.x2 += x * x;
+    s.x3 += x * x * x;
+    s.x4 += x * x * x * x;
+    s.y += y;
+    s.xy += x * y;
+    s.x2y += x * x * y;
+}
+
+void addSums(FitSums &to, const FitSums &from)
+{
+    if (from.n == 0)
+    {
+        return;
+    }
+    if (to.n == 0 || from.xMin < to.xMin)
+    {
+        to.xMin = from.xMin;
+    }
+    if (to.n == 0 || from.xMax > to.xMax)
+    {
+        to.xMax = from.xMax;
+    }
+    to.n += from.n;
+    to.x += from.x;
+    to.x2 += from.x2;
+    to.x3 += from.x3;
+    to.x4 += from.x4;
+    to.y += from.y;
+    to.xy += from.xy;
+    to.x2y += from.x2y;
+}
+
+void resetCalibration()
+{
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        calibration.gain[i] = 1.0;
+        calibration.offset[i] = 0.0;
+        calibration.curve[i] = 0.0;
+    }
+}
+
+uint16_t calibrationCrc(const CalibrationRecord &record)
+{
+    return crc16((const uint8_t *)&record, offsetof(CalibrationRecord, crc));
+}
+
+void loadCalibration()
+{
+    CalibrationRecord record;
+    EEPROM.get(CAL_EEPROM_ADDR, record);
+
+    if (record.magic != CAL_MAGIC || record.version != CAL_VERSION ||
+        record.size != sizeof(SensorCalibration) || record.crc != calibrationCrc(record))
+    {
+        resetCalibration();
+        Serial.println(F("No valid sensor calibration stored - using identity"));
+        return;
+    }
+
+    calibration = record.cal;
+    Serial.println(F("Sensor calibration loaded"));
+}
+
+void saveCalibration()
+{
+    CalibrationRecord record;
+    memset(&record, 0, sizeof(record)); // Padding bytes are part of the CRC
+    record.magic = CAL_MAGIC;
+    record.version = CAL_VERSION;
+    record.size = sizeof(SensorCalibration);
+    record.cal = calibration;
+    record.crc = calibrationCrc(record);
+    EEPROM.put(CAL_EEPROM_ADDR, record);
+}
+
+// Solve the 3x3 normal equations for a quadratic fit (Cramer's rule); false if singular
+bool fitQuadratic(const FitSums &raw, float &c2, float &c1, float &c0)
+{
+    // Work in units of the RMS reading, so every moment is of order n and the singularity
+    // test is relative to the data rather than to its lux scale
+    double k = raw.n > 0 ? sqrt(raw.x2 / raw.n) : 0;
+    if (!(k > 0))
+    {
+        return false;
+    }
+    FitSums s = raw;
+    s.x /= k;
+    s.x2 /= k * k;
+    s.x3 /= k * k * k;
+    s.x4 /= k * k * k * k;
+    s.xy /= k;
+    s.x2y /= k * k;
+
+    // | x4 x3 x2 | |c2|   | x2y |
+    // | x3 x2 x  | |c1| = | xy  |
+    // | x2 x  n  | |c0|   | y   |
+    double det = s.x4 * (s.x2 * s.n - s.x * s.x) - s.x3 * (s.x3 * s.n - s.x * s.x2) + s.x2 * (s.x3 * s.x - s.x2 * s.x2);
+    if (fabs(det) < CAL_SINGULAR_TOLERANCE * s.n * s.n * s.n)
+    {
+        return false;
+    }
+    c2 = (s.x2y * (s.x2 * s.n - s.x * s.x) - s.x3 * (s.xy * s.n - s.x * s.y) + s.x2 * (s.xy * s.x - s.x2 * s.y)) / det / (k * k);
+    c1 = (s.x4 * (s.xy * s.n - s.x * s.y) - s.x2y * (s.x3 * s.n - s.x * s.x2) + s.x2 * (s.x3 * s.y - s.xy * s.x2)) / det / k;
+    c0 = (s.x4 * (s.x2 * s.y - s.x * s.xy) - s.x3 * (s.x3 * s.y - s.xy * s.x2) + s.x2y * (s.x3 * s.x - s.x2 * s.x2)) / det;
+    return true;
+}
+
+// A correction has to keep brighter readings brighter over the range it was fitted on
+bool fitIsMonotonic(const FitSums &s, float gain, float curve)
+{
+    return gain + 2 * curve * s.xMin > 0 && gain + 2 * curve * s.xMax > 0;
+}
+
+// Fit one sensor with the most detailed model the collected data supports
+void fitSensor(const FitSums &s, uint8_t levels, uint8_t sensor)
+{
+    float gain = 1.0, offset = 0.0, curve = 0.0;
+
+    // levels counts distinct light levels only, so each model below has the data it needs
+    if (CAL_FIT_CURVE && levels >= 3 && fitQuadratic(s, curve, gain, offset) && fitIsMonotonic(s, gain, curve))
+    {
+        // Quadratic fit done
+    }
+    else
+    {
+        // Linear fit needs at least two distinct light levels, otherwise fit gain only
+        double varX = s.n * s.x2 - s.x * s.x;
+        gain = 1.0;
+        offset = 0.0;
+        curve = 0.0;
+        bool linear = levels >= 2 && varX > CAL_SINGULAR_TOLERANCE * s.n * s.x2;
+        if (linear)
+        {
+            gain = (s.n * s.xy - s.x * s.y) / varX;
+            offset = (s.y - gain * s.x) / s.n;
+        }
+        if ((!linear || !(gain > 0)) && s.x2 > 0)
+        {
+            gain = s.xy / s.x2;
+            offset = 0.0;
+        }
+        if (!(gain > 0))
+        {
+            gain = 1.0; // Nothing usable; leave this sensor uncorrected
+            offset = 0.0;
+        }
+    }
+
+    calibration.gain[sensor] = gain;
+    calibration.offset[sensor] = offset;
+    calibration.curve[sensor] = curve;
+}
+
+// Wait for a command character from the serial monitor; 0 if none came within
+// CAL_COMMAND_TIMEOUT_MS (so an unattended board goes back to logging)
+char waitForCommand()
+{
+    unsigned long start = millis();
+    while (Serial.available() == 0)
+    {
+        if (millis() - start > CAL_COMMAND_TIMEOUT_MS)
+        {
+            return 0;
+        }
+    }
+    return Serial.read();
+}
+
+void runCalibration()
+{
+    Serial.println(F("--- Sensor calibration ---"));
+    Serial.println(F("Put all sensors under the same uniform light."));
+    Serial.println(F("For each light level send 'n' to sample it. Use several levels for an offset/curve fit."));
+    Serial.println(F("Send 'f' to finish and save, 'x' to abort."));
+
+    FitSums sums[SENSOR_COUNT];
+    memset(sums, 0, sizeof(sums));
+    float levelMeans[CAL_MAX_LEVELS]; // Reference lux of each distinct level so far
+    uint8_t levels = 0;
+
+    while (true)
+    {
+        char command = waitForCommand();
+        if (command == 0)
+        {
+            Serial.println(F("Calibration timed out - unchanged"));
+            return;
+        }
+        if (command == 'x')
+        {
+            Serial.println(F("Calibration aborted"));
+            return;
+        }
+        if (command == 'f')
+        {
+            break;
+        }
+        if (command != 'n')
+        {
+            continue;
+        }
+
+        FitSums levelSums[SENSOR_COUNT];
+        memset(levelSums, 0, sizeof(levelSums));
+        for (uint16_t i = 0; i < CAL_SAMPLES_PER_LEVEL; i++)
+        {
+            // Uncorrected readings - the fit is relative to the raw sensor response
+            SensorData data = readRawSensors();
+            bool allValid = true;
+            double reference = 0;
+            for (uint8_t s = 0; s < SENSOR_COUNT; s++)
+            {
+                allValid &= data.valid[s];
+                reference += data.lux[s];
+            }
+            if (!allValid)
+            {
+                continue; // Skip failed or dark readings
+            }
+            reference /= SENSOR_COUNT;
+
+            for (uint8_t s = 0; s < SENSOR_COUNT; s++)
+            {
+                addSample(levelSums[s], data.lux[s], reference);
+            }
+        }
+
+        if (levelSums[0].n == 0)
+        {
+            Serial.println(F("No valid readings at this level - not counted"));
+            continue;
+        }
+        for (uint8_t s = 0; s < SENSOR_COUNT; s++)
+        {
+            addSums(sums[s], levelSums[s]);
+        }
+
+        // Only a level clearly different from the earlier ones adds information for the
+        // offset/curve terms; a repeat still improves the gain estimate
+        float mean = levelSums[0].y / levelSums[0].n;
+        bool distinct = levels < CAL_MAX_LEVELS;
+        for (uint8_t l = 0; l < levels && distinct; l++)
+        {
+            distinct = fabs(mean - levelMeans[l]) > CAL_MIN_LEVEL_STEP * fmaxf(mean, levelMeans[l]);
+        }
+        if (!distinct)
+        {
+            Serial.println(F("Level matches an earlier one - change the light for another level"));
+            continue;
+        }
+        levelMeans[levels++] = mean;
+        Serial.print(F("Level "));
+        Serial.print(levels);
+        Serial.println(F(" sampled. 'n' for another level, 'f' to finish."));
+    }
+
+    if (levels == 0 || sums[0].n == 0)
+    {
+        Serial.println(F("No samples collected - calibration unchanged"));
+        return;
+    }
+
+    for (uint8_t s = 0; s < SENSOR_COUNT; s++)
+    {
+        fitSensor(sums[s], levels, s);
+        Serial.print(F("Sensor "));
+        Serial.print(s + 1);
+        Serial.print(F(": gain "));
+        Serial.print(calibration.gain[s], 5);
+        Serial.print(F(" offset "));
+        Serial.print(calibration.offset[s], 3);
+        Serial.print(F(" curve "));
+        Serial.println(calibration.curve[s], 9);
+    }
+
+    saveCalibration();
+    Serial.println(F("Calibration saved"));
+}
@@ -0,0 +1,24 @@
+/*
+ * Per-sensor calibration - removes gain/offset mismatch between the light sensors
+ */
+
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <Arduino.h>
+#include "sensors.h"
+#include "calibration_kernel.h"
+
+// Load the calibration stored in EEPROM, falling back to identity if it is missing or corrupt
+void loadCalibration();
+
+// Store the current calibration in EEPROM
+void saveCalibration();
+
+// Reset to identity (no correction)
+void resetCalibration();
+
+// Guided calibration under uniform light, driven from the serial monitor
+void runCalibration();
+
+#endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+/*
+ * Calibration coefficients and the per-sample correction kernel
+ * No Arduino dependencies, so host tools apply exactly the same correction
+ */
+
+#ifndef CALIBRATION_KERNEL_H
+#define CALIBRATION_KERNEL_H
+
+#include "sensor_frame.h"
+
+// Correction applied to each sensor: lux' = (curve * lux + gain) * lux + offset
+struct SensorCalibration
+{
+    float gain[SENSOR_COUNT];
+    float offset[SENSOR_COUNT];
+    float curve[SENSOR_COUNT];
+};
+
+extern SensorCalibration calibration;
+
+// Correct one reading. Written as a single multiply-add chain with a select for failed (0)
+// readings so it stays branch-free and cheap in the sample path. A negative offset can take
+// a dim reading to 0 or below; that comes out as 0, the same as a failed reading.
+inline float calibrateLux(float lux, uint8_t sensor)
+{
+    float corrected = (calibration.curve[sensor] * lux + calibration.gain[sensor]) * lux + calibration.offset[sensor];
+    return lux > 0 && corrected > 0 ? corrected : 0;
+}
+
+inline void applyCalibration(SensorData &data)
+{
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        data.lux[i] = calibrateLux(data.lux[i], i);
+        data.valid[i] = data.valid[i] && data.lux[i] > 0; // Corrected to nothing: keep it out of the fit
+    }
+}
+
+#endif
@@ -0,0 +1,64 @@
+/*
+ * Consistent Overhead Byte Stuffing - removes 0x00 from a frame so 0x00 can delimit frames
+ */
+
+#ifndef COBS_H
+#define COBS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Encode len bytes from in to out (out needs len + len / 254 + 1 bytes); returns encoded length
+inline size_t cobsEncode(const uint8_t *in, size_t len, uint8_t *out)
+{
+    size_t codePos = 0;
+    size_t outPos = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (in[i] == 0)
+        {
+            out[codePos] = code;
+            codePos = outPos++;
+            code = 1;
+            continue;
+        }
+        out[outPos++] = in[i];
+        if (++code == 0xFF)
+        {
+            out[codePos] = code;
+            codePos = outPos++;
+            code = 1;
+        }
+    }
+    out[codePos] = code;
+    return outPos;
+}
+
+// Decode len bytes (without the 0x00 delimiter) from in to out; returns decoded length, 0 on error
+inline size_t cobsDecode(const uint8_t *in, size_t len, uint8_t *out)
+{
+    size_t inPos = 0;
+    size_t outPos = 0;
+
+    while (inPos < len)
+    {
+        uint8_t code = in[inPos++];
+        if (code == 0 || inPos + code - 1 > len)
+        {
+            return 0;
+        }
+        for (uint8_t i = 1; i < code; i++)
+        {
+            out[outPos++] = in[inPos++];
+        }
+        if (code != 0xFF && inPos < len)
+        {
+            out[outPos++] = 0;
+        }
+    }
+    return outPos;
+}
+
+#endif
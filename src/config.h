@@ -5,6 +5,8 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include <stdint.h>
+
 // #define SENSOR_1_XPOS 5.0
 // #define SENSOR_1_YPOS 1.0
 // #define SENSOR_2_XPOS -9.7
@@ -14,11 +16,20 @@
 
 // #def
 
+// Number of light sensors in the array (up to SENSOR_MAX)
+// The TSL2561 ADDR pin only allows three addresses, so larger arrays put sensors behind
+// a TCA9548A I2C multiplexer (see SENSOR_MUX_CHANNEL below)
+const uint8_t SENSOR_COUNT = 3;
+const uint8_t SENSOR_MAX = 8;
+static_assert(SENSOR_COUNT >= 3 && SENSOR_COUNT <= SENSOR_MAX, "Gradient needs 3 to SENSOR_MAX sensors");
+
 // Sensor positions (x,y) in cm relative to center
 // Triangular pattern with sensors at the corners
-const float SENSOR1_POS[2] = {5.0, 1};     // Right
-const float SENSOR2_POS[2] = {-9.7, 5.0};  // Top left
-const float SENSOR3_POS[2] = {-9.7, -4.5}; // Bottom left
+const float SENSOR_POS[SENSOR_COUNT][2] = {
+    {5.0, 1},     // Right
+    {-9.7, 5.0},  // Top left
+    {-9.7, -4.5}, // Bottom left
+};
 
 // Servo control settings
 const int SERVO_PIN = 9;         // Servo signal pin (Servo1 on the shield)
@@ -33,12 +44,74 @@ const int SCREEN_ADDRESS = 0x3C; // I2C address for the display (typically 0x3C
 
 // Sensor I2C addresses
 // TSL2561 has three possible addresses based on the ADDR pin connection
-#define SENSOR1_ADDR TSL2561_ADDR_FLOAT // ADDR pin floating
-#define SENSOR2_ADDR TSL2561_ADDR_LOW   // ADDR pin connected to GND
-#define SENSOR3_ADDR TSL2561_ADDR_HIGH  // ADDR pin connected to VCC
+const uint8_t SENSOR_ADDR[SENSOR_COUNT] = {
+    0x39, // TSL2561_ADDR_FLOAT - ADDR pin floating
+    0x29, // TSL2561_ADDR_LOW   - ADDR pin connected to GND
+    0x49, // TSL2561_ADDR_HIGH  - ADDR pin connected to VCC
+};
+
+// I2C multiplexer channel for each sensor, -1 if the sensor is on the main bus
+const uint8_t SENSOR_MUX_ADDR = 0x70; // TCA9548A default address
+const int8_t SENSOR_MUX_CHANNEL[SENSOR_COUNT] = {-1, -1, -1};
 
 // System settings
-const int UPDATE_DELAY = 500; // Delay between updates in milliseconds
+const unsigned long SERIAL_BAUD = 115200; // Serial monitor / telemetry baud rate
+// TX buffer size assumed for telemetry when the core's Serial.availableForWrite() is not
+// implemented (Print's default returns 0)
+const uint16_t TLM_TX_BUFFER_FALLBACK = 256;
+const int UPDATE_DELAY = 500; // Delay between updates in milliseconds (with PIPELINE_PACE)
+const uint8_t TEMP_HUM_INTERVAL = 20; // Read temperature/humidity every N loops
+const bool SD_DEBUG = false;          // Echo SD writes to serial instead of the card
+
+// Sample pipeline stages (see pipeline.h); a disabled stage is not compiled into the firmware
+const bool PIPELINE_TIMING = true;          // Per-stage timings in the TLM_TIMINGS frame
+const bool PIPELINE_CALIBRATE = true;       // Per-sensor calibration
+const bool PIPELINE_ALIGN = true;           // Sensor time-skew compensation
+const bool PIPELINE_FLIGHT_RECORDER = true; // RAM capture around lux/angle events
+const bool PIPELINE_TEMP_HUM = true;        // Temperature/humidity sensor
+const bool PIPELINE_DISPLAY = true;         // OLED display
+const bool PIPELINE_SERVO = false;          // Point the servo along the gradient
+const bool PIPELINE_SD_LOG = true;          // CSV log on the SD card
+const bool PIPELINE_RTC_STAMP = true;       // RTC datestamp column in the log
+const bool PIPELINE_TELEMETRY = true;       // Binary telemetry frames over serial
+const bool PIPELINE_UPLINK = true;          // Batched UDP uplink
+const bool PIPELINE_PACE = false;           // Hold each loop to at least UPDATE_DELAY
+
+// Sensor time-skew compensation
+// Readings older than this are not trusted for extrapolating a sensor forward in time. It has
+// to cover at least one loop period or compensation never runs, so a paced loop widens it.
+const unsigned long SKEW_MAX_HISTORY_US = PIPELINE_PACE && 2000UL * UPDATE_DELAY > 250000 ? 2000UL * UPDATE_DELAY : 250000;
+static_assert(!PIPELINE_PACE || 1000UL * UPDATE_DELAY < SKEW_MAX_HISTORY_US,
+              "SKEW_MAX_HISTORY_US is shorter than the paced loop period; skew compensation would never run");
+
+// Flight recorder (RAM capture of raw samples around a trigger)
+const uint16_t FR_CAPACITY = 512;             // Samples kept in RAM (6 + 4 bytes per sensor each)
+const uint16_t FR_POST_TRIGGER = 128;         // Samples recorded after the trigger fires
+const float FR_LUX_STEP_THRESHOLD = 50.0;     // Average lux change between samples that triggers
+const float FR_ANGLE_JUMP_THRESHOLD = 30.0;   // Angle change (degrees) between samples that triggers
+
+// Sensor calibration
+const int CAL_EEPROM_ADDR = 0;               // EEPROM (data flash) address of the calibration block
+const uint16_t CAL_SAMPLES_PER_LEVEL = 50;   // Readings averaged into the fit per light level
+const bool CAL_FIT_CURVE = true;             // Fit a lux-dependent curve when 3+ levels are sampled
+const float CAL_MIN_LEVEL_STEP = 0.2;        // Levels closer than this (relative) count as the same one
+const uint8_t CAL_MAX_LEVELS = 16;           // Distinct levels used for the fit
+const unsigned long CAL_COMMAND_TIMEOUT_MS = 120000; // Calibration gives up if no command comes
+const unsigned long COMMAND_CONFIRM_MS = 10000;      // Window for the 'y' that confirms 'c' or 'r'
+
+// Log index (N.idx sidecar for fast time-range queries)
+const uint16_t LOG_INDEX_STRIDE = 64; // Records between index entries
+
+// Network uplink (batched UDP over the UNO R4 WiFi module); leave the SSID empty to disable
+const char UPLINK_SSID[] = "";
+const char UPLINK_PASS[] = "";
+const uint8_t UPLINK_HOST[4] = {192, 168, 1, 100}; // Receiver address (tools/uplink_rx)
+const uint16_t UPLINK_PORT = 5005;                 // Receiver UDP port (also the local port)
+const uint16_t UPLINK_BATCH_SAMPLES = 16;          // Samples per datagram
+const uint8_t UPLINK_QUEUE_BATCHES = 4;            // Batches buffered while the network catches up
+const unsigned long UPLINK_MIN_INTERVAL_MS = 100;  // Minimum time between datagrams (and WiFi status polls)
+const unsigned long UPLINK_RECONNECT_MS = 30000;   // Time between reconnect attempts (non-blocking)
+const unsigned long UPLINK_CONNECT_TIMEOUT_MS = 10000; // How long to wait for the first join in setup()
 
 // Data wire is plugged into port 2 on the Arduino
 // #define ONE_WIRE_BUS 2
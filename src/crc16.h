@@ -0,0 +1,32 @@
+/*
+ * CRC-16/CCITT-FALSE used to check binary records sent to the host
+ */
+
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+const uint16_t CRC16_INIT = 0xFFFF;
+
+// Fold len bytes into a running CRC (start from CRC16_INIT)
+inline uint16_t crc16Update(uint16_t crc, const uint8_t *data, size_t len)
+{
+    while (len--)
+    {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+inline uint16_t crc16(const uint8_t *data, size_t len)
+{
+    return crc16Update(CRC16_INIT, data, len);
+}
+
+#endif
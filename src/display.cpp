@@ -26,6 +26,7 @@ struct DisplayState
     int lastArrowX = -1, lastArrowY = -1;
     int lastArrowX2 = -1, lastArrowY2 = -1;
     int lastArrowX3 = -1, lastArrowY3 = -1;
+    int barHeight[SENSOR_COUNT] = {}; // Bars start empty, matching the cleared screen
 };
 DisplayState lastState;
 // --- End Optimization ---
@@ -118,6 +119,27 @@ void updateDisplay(float angle, float avgLux, const SensorData &data, float temp
     }
     // --- End Optimization ---
 
+    // Per-sensor balance bars along the bottom, scaled to the brightest sensor
+    const int barTop = 55, barMaxHeight = 9, barAreaWidth = 80;
+    const int barWidth = barAreaWidth / SENSOR_COUNT - 2;
+    float maxLux = 0;
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        maxLux = fmax(maxLux, data.lux[i]);
+    }
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        int height = maxLux > 0 ? (int)(data.lux[i] / maxLux * barMaxHeight + 0.5f) : 0;
+        if (height != lastState.barHeight[i])
+        {
+            int x = i * (barWidth + 2);
+            display.fillRect(x, barTop, barWidth, barMaxHeight, SSD1306_BLACK);
+            display.fillRect(x, barTop + barMaxHeight - height, barWidth, height, SSD1306_WHITE);
+            lastState.barHeight[i] = height;
+            changed = true;
+        }
+    }
+
     // --- Optimization: Update arrow only if angle changed ---
     if (changed)
     {                       // Only redraw arrow if any value changed (or force redraw if needed)
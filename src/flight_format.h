@@ -0,0 +1,52 @@
+/*
+ * Flight recorder dump format, shared by the firmware and the host decoder
+ * All fields are little-endian
+ */
+
+#ifndef FLIGHT_FORMAT_H
+#define FLIGHT_FORMAT_H
+
+#include <stdint.h>
+
+// Compact raw sample as stored in RAM and sent to the host, for N sensors
+// (the host works out N from the dump header)
+template <uint8_t N>
+struct __attribute__((packed)) FlightSampleN
+{
+    uint32_t t_us;         // micros() of the newest sensor reading
+    uint16_t broadband[N]; // Raw broadband counts per sensor
+    uint16_t ir[N];        // Raw infrared counts per sensor
+    int16_t angle;         // Gradient angle in hundredths of a degree
+};
+
+// Size of one sample on the wire for a given sensor count
+inline uint16_t flightSampleSize(uint8_t channels)
+{
+    return sizeof(uint32_t) + 2 * channels * sizeof(uint16_t) + sizeof(int16_t);
+}
+
+// What caused the recorder to trigger
+enum FlightTrigger : uint8_t
+{
+    FR_TRIGGER_NONE = 0,
+    FR_TRIGGER_LUX_STEP = 1,
+    FR_TRIGGER_ANGLE_JUMP = 2,
+    FR_TRIGGER_MANUAL = 3,
+};
+
+// Dump header, followed by `count` samples (oldest first) and a CRC-16 of everything before it
+struct __attribute__((packed)) FlightDumpHeader
+{
+    char magic[4];         // "FREC"
+    uint8_t version;       // FR_DUMP_VERSION
+    uint8_t channels;      // Sensors per sample
+    uint16_t sampleSize;   // flightSampleSize(channels)
+    uint16_t count;        // Samples that follow
+    uint16_t triggerIndex; // Index of the trigger sample, 0xFFFF if not triggered
+    uint8_t triggerCause;  // FlightTrigger
+    uint8_t reserved;
+};
+
+const uint8_t FR_DUMP_VERSION = 1;
+
+#endif
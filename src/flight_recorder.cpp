@@ -0,0 +1,158 @@
+/*
+ * RAM flight recorder implementation
+ *
+ * Samples go into a circular buffer until a trigger fires. After the trigger we keep
+ * recording FR_POST_TRIGGER more samples and then freeze, so the buffer holds
+ * FR_CAPACITY - FR_POST_TRIGGER samples of pre-trigger history plus the post-trigger window.
+ */
+
+#include "flight_recorder.h"
+#include "config.h"
+#include "crc16.h"
+
+FlightSample frBuffer[FR_CAPACITY];
+uint16_t frHead = 0;  // Next slot to write
+uint16_t frCount = 0; // Valid samples in the buffer
+
+enum FlightState : uint8_t
+{
+    FR_ARMED,     // Recording, watching for a trigger
+    FR_TRIGGERED, // Recording the post-trigger window
+    FR_FROZEN,    // Capture complete, waiting for dump/re-arm
+};
+
+FlightState frState = FR_ARMED;
+FlightTrigger frCause = FR_TRIGGER_NONE;
+uint16_t frTriggerSlot = 0;     // Buffer slot holding the trigger sample
+uint16_t frPostRemaining = 0;   // Samples still to record after the trigger
+bool frPendingManual = false;   // Manual trigger requested
+bool frHavePrevious = false;    // Previous sample available for step detection
+float frPrevLux = 0;
+float frPrevAngle = 0;
+
+void armFlightRecorder()
+{
+    frHead = 0;
+    frCount = 0;
+    frState = FR_ARMED;
+    frCause = FR_TRIGGER_NONE;
+    frPendingManual = false;
+    frHavePrevious = false;
+}
+
+void triggerFlightRecorder()
+{
+    frPendingManual = true;
+}
+
+// Decide whether this sample should trigger the capture
+FlightTrigger checkTrigger(float angle, float avgLux)
+{
+    if (frPendingManual)
+    {
+        frPendingManual = false;
+        return FR_TRIGGER_MANUAL;
+    }
+    if (!frHavePrevious)
+    {
+        return FR_TRIGGER_NONE;
+    }
+    if (fabs(avgLux - frPrevLux) > FR_LUX_STEP_THRESHOLD)
+    {
+        return FR_TRIGGER_LUX_STEP;
+    }
+
+    // Compare angles the short way round the circle
+    float jump = fabs(angle - frPrevAngle);
+    if (jump > 180.0)
+    {
+        jump = 360.0 - jump;
+    }
+    if (jump > FR_ANGLE_JUMP_THRESHOLD)
+    {
+        return FR_TRIGGER_ANGLE_JUMP;
+    }
+    return FR_TRIGGER_NONE;
+}
+
+void recordFlightSample(const SensorData &data, float angle, float avgLux)
+{
+    if (frState == FR_FROZEN)
+    {
+        return;
+    }
+
+    uint16_t slot = frHead;
+    FlightSample &sample = frBuffer[slot];
+    sample.t_us = frameNewest(data);
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        sample.broadband[i] = data.broadband[i];
+        sample.ir[i] = data.ir[i];
+    }
+    sample.angle = (int16_t)lroundf(angle * 100.0f);
+
+    frHead = (frHead + 1) % FR_CAPACITY;
+    if (frCount < FR_CAPACITY)
+    {
+        frCount++;
+    }
+
+    if (frState == FR_ARMED)
+    {
+        FlightTrigger cause = checkTrigger(angle, avgLux);
+        if (cause != FR_TRIGGER_NONE)
+        {
+            frState = FR_TRIGGERED;
+            frCause = cause;
+            frTriggerSlot = slot;
+            frPostRemaining = FR_POST_TRIGGER;
+        }
+    }
+    else if (frState == FR_TRIGGERED && --frPostRemaining == 0)
+    {
+        frState = FR_FROZEN;
+    }
+
+    frPrevLux = avgLux;
+    frPrevAngle = angle;
+    frHavePrevious = true;
+}
+
+void dumpFlightRecorder()
+{
+    // Oldest sample sits at the head once the buffer has wrapped
+    uint16_t first = (frCount < FR_CAPACITY) ? 0 : frHead;
+
+    FlightDumpHeader header;
+    memcpy(header.magic, "FREC", 4);
+    header.version = FR_DUMP_VERSION;
+    header.channels = SENSOR_COUNT;
+    header.sampleSize = sizeof(FlightSample);
+    header.count = frCount;
+    header.triggerIndex = 0xFFFF;
+    header.triggerCause = frCause;
+    header.reserved = 0;
+    if (frCause != FR_TRIGGER_NONE)
+    {
+        header.triggerIndex = (frTriggerSlot + FR_CAPACITY - first) % FR_CAPACITY;
+    }
+
+    uint16_t crc = crc16((const uint8_t *)&header, sizeof(header));
+    Serial.write((const uint8_t *)&header, sizeof(header));
+
+    // Send in at most two contiguous runs: first..end of buffer, then start..head
+    uint16_t firstRun = (first + frCount <= FR_CAPACITY) ? frCount : FR_CAPACITY - first;
+    const uint8_t *run = (const uint8_t *)&frBuffer[first];
+    crc = crc16Update(crc, run, firstRun * sizeof(FlightSample));
+    Serial.write(run, firstRun * sizeof(FlightSample));
+    if (firstRun < frCount)
+    {
+        run = (const uint8_t *)&frBuffer[0];
+        crc = crc16Update(crc, run, (frCount - firstRun) * sizeof(FlightSample));
+        Serial.write(run, (frCount - firstRun) * sizeof(FlightSample));
+    }
+
+    Serial.write((const uint8_t *)&crc, sizeof(crc));
+    Serial.flush();
+}
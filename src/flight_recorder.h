@@ -0,0 +1,26 @@
+/*
+ * RAM flight recorder - captures raw samples at full loop rate around a trigger
+ */
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <Arduino.h>
+#include "sensors.h"
+#include "flight_format.h"
+
+typedef FlightSampleN<SENSOR_COUNT> FlightSample;
+
+// Clear the capture and start watching for a trigger again
+void armFlightRecorder();
+
+// Trigger the capture by hand (e.g. from a serial command)
+void triggerFlightRecorder();
+
+// Record one sample; call once per sensor read
+void recordFlightSample(const SensorData &data, float angle, float avgLux);
+
+// Write the capture to the serial port in the binary dump format
+void dumpFlightRecorder();
+
+#endif
@@ -1,50 +1,143 @@
 /*
  * Gradient calculation implementation
+ * Plain C++ with no Arduino dependencies, so the host reprocessing tool builds this same file
  */
 
-#include <Arduino.h>
+#include <math.h>
 #include "gradient.h"
 #include "config.h"
 
-void calculateGradient(float lux1, float lux2, float lux3, float &gradientX, float &gradientY)
+// Previous reading of each sensor, used to estimate how fast its value is changing
+struct SensorHistory
 {
-    // This function calculates the gradient vector of the light field
-    // using a planar approximation from three sensor readings
+    float lux = 0;
+    unsigned long t = 0;
+    bool valid = false;
+};
+SensorHistory history[SENSOR_COUNT];
 
-    // Simple calculation for the plane coefficients (gradient)
-    // Using the formula from planar interpolation
-    float denominator = (SENSOR1_POS[0] * (SENSOR2_POS[1] - SENSOR3_POS[1]) +
-                         SENSOR2_POS[0] * (SENSOR3_POS[1] - SENSOR1_POS[1]) +
-                         SENSOR3_POS[0] * (SENSOR1_POS[1] - SENSOR2_POS[1]));
+// Extrapolate one reading from time t to time tRef using its last known slope
+float alignReading(SensorHistory &prev, float lux, unsigned long t, unsigned long tRef)
+{
+    float aligned = lux;
 
-    if (abs(denominator) < 0.0001)
+    // Signed differences keep this correct across the micros() rollover
+    long dtPrev = (long)(t - prev.t);
+    if (prev.valid && dtPrev > 0 && (unsigned long)dtPrev < SKEW_MAX_HISTORY_US)
     {
-        // Handle the case where sensors are collinear
-        gradientX = 0;
-        gradientY = 0;
-        return;
+        float slope = (lux - prev.lux) / dtPrev;
+        aligned += slope * (long)(tRef - t);
     }
 
-    // Calculate partial derivatives (gradient components)
-    gradientX = (lux1 * (SENSOR2_POS[1] - SENSOR3_POS[1]) +
-                 lux2 * (SENSOR3_POS[1] - SENSOR1_POS[1]) +
-                 lux3 * (SENSOR1_POS[1] - SENSOR2_POS[1])) /
-                denominator;
+    prev.lux = lux;
+    prev.t = t;
+    prev.valid = true;
+    return aligned;
+}
 
-    gradientY = (lux1 * (SENSOR3_POS[0] - SENSOR2_POS[0]) +
-                 lux2 * (SENSOR1_POS[0] - SENSOR3_POS[0]) +
-                 lux3 * (SENSOR2_POS[0] - SENSOR1_POS[0])) /
-                denominator;
+void alignSensorData(SensorData &data)
+{
+    // The sensors are read one after another, so align everything to the newest sample
+    unsigned long tRef = frameNewest(data);
 
-    // Normalize gradient direction (but keep magnitude for strength)
-    float magnitude = sqrt(gradientX * gradientX + gradientY * gradientY);
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        if (data.valid[i])
+        {
+            data.lux[i] = alignReading(history[i], data.lux[i], data.t[i], tRef);
+        }
+        else
+        {
+            history[i].valid = false; // Don't extrapolate across a failed reading
+        }
+        data.t[i] = tRef;
+    }
+}
 
-    if (magnitude > 0)
+// Solve the weights over the channels set in mask; the others get weight 0
+void computeGradientWeights(GradientSolver &solver, uint8_t mask)
+{
+    // Least-squares fit of lux = a + gx * x + gy * y, solved on positions centred on their mean
+    // (for three sensors this is exactly the plane through the three readings)
+    float meanX = 0, meanY = 0;
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        if (mask & (1 << i))
+        {
+            meanX += SENSOR_POS[i][0];
+            meanY += SENSOR_POS[i][1];
+            count++;
+        }
+    }
+    if (count > 0)
     {
-        // We keep the magnitude information for potential future use
-        // but normalize for consistency in direction
-        float normFactor = magnitude;
-        // gradientX /= normFactor;
-        // gradientY /= normFactor;
+        meanX /= count;
+        meanY /= count;
+    }
+
+    float sxx = 0, syy = 0, sxy = 0;
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        if (mask & (1 << i))
+        {
+            float dx = SENSOR_POS[i][0] - meanX;
+            float dy = SENSOR_POS[i][1] - meanY;
+            sxx += dx * dx;
+            syy += dy * dy;
+            sxy += dx * dy;
+        }
+    }
+
+    float det = sxx * syy - sxy * sxy;
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        float dx = SENSOR_POS[i][0] - meanX;
+        float dy = SENSOR_POS[i][1] - meanY;
+
+        if (count < 3 || fabs(det) < 0.0001 || !(mask & (1 << i)))
+        {
+            // Too few sensors for a plane, collinear sensors, or a failed reading
+            solver.weightX[i] = 0;
+            solver.weightY[i] = 0;
+            continue;
+        }
+        solver.weightX[i] = (syy * dx - sxy * dy) / det;
+        solver.weightY[i] = (sxx * dy - sxy * dx) / det;
     }
-}
\ No newline at end of file
+    solver.mask = mask;
+}
+
+void calculateGradient(GradientSolver &solver, const SensorData &data, float &gradientX, float &gradientY)
+{
+    // This function calculates the gradient vector of the light field
+    // using a planar approximation from the valid sensor readings
+    uint8_t mask = 0;
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        mask |= (uint8_t)data.valid[i] << i;
+    }
+
+    // Re-solve only when the set of valid sensors changes; with fewer than three the
+    // weights are all zero and so is the gradient
+    if (mask != solver.mask)
+    {
+        computeGradientWeights(solver, mask);
+    }
+
+    float gx = 0, gy = 0;
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        gx += solver.weightX[i] * data.lux[i];
+        gy += solver.weightY[i] * data.lux[i];
+    }
+
+    // Magnitude is kept in the vector as a measure of gradient strength
+    gradientX = gx;
+    gradientY = gy;
+}
+
+float gradientAngle(float gradientX, float gradientY)
+{
+    return atan2f(gradientY, gradientX) * 180.0f / (float)M_PI;
+}
@@ -5,8 +5,27 @@
 #ifndef GRADIENT_H
 #define GRADIENT_H
 
-// Calculate the gradient of light field using the three sensor readings
-void calculateGradient(float lux1, float lux2, float lux3, float &gradientX, float &gradientY);
+#include "sensor_frame.h"
+
+// Extrapolate each reading to the newest sample time so the gradient sees one instant
+void alignSensorData(SensorData &data);
+
+// Per-sensor weights of the plane fit: gradientX = sum(weightX[i] * lux[i]), same for Y.
+// They depend only on SENSOR_POS and which sensors are valid, so they are re-solved only
+// when the valid set changes. Owned by the caller (one per thread in host tools).
+struct GradientSolver
+{
+    float weightX[SENSOR_COUNT] = {};
+    float weightY[SENSOR_COUNT] = {};
+    uint8_t mask = 0; // Valid channels the weights were solved for (0 = none, all weights 0)
+};
+
+// Calculate the gradient of the light field from the valid sensor readings (least-squares plane fit)
+void calculateGradient(GradientSolver &solver, const SensorData &data, float &gradientX, float &gradientY);
+
+// Direction of the gradient in degrees (counter-clockwise from +x)
+float gradientAngle(float gradientX, float gradientY);
+
 // void normalizeSensorPos();
 void normalizeVector(float &x, float &y);
 
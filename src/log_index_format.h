@@ -0,0 +1,50 @@
+/*
+ * SD log index format, shared by the firmware (ourSD) and the host query tool
+ *
+ * Sidecar index (N.idx next to N.csv): an IndexHeader, then one IndexEntry every `stride`
+ * records. Little-endian.
+ */
+
+#ifndef LOG_INDEX_FORMAT_H
+#define LOG_INDEX_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct __attribute__((packed)) IndexHeader
+{
+    char magic[4];   // "LIDX"
+    uint16_t version;
+    uint16_t stride; // Records between entries
+};
+
+struct __attribute__((packed)) IndexEntry
+{
+    uint32_t t_ms;   // millis() when the record was started (never later than its Time column)
+    uint32_t offset; // Byte offset of the record in the CSV file
+};
+
+const uint16_t INDEX_VERSION = 1;
+
+// Byte offset to start reading from for records at or after t_ms: the offset of the last
+// entry before t_ms (entries are in time order), or 0 if there is none. Strictly before, so
+// records sharing t_ms that precede an entry with that time are not skipped.
+inline uint32_t indexSeek(const IndexEntry *entries, size_t count, uint32_t t_ms)
+{
+    size_t lo = 0, hi = count; // First entry with t_ms >= the target
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (entries[mid].t_ms < t_ms)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo > 0 ? entries[lo - 1].offset : 0;
+}
+
+#endif
@@ -1,6 +1,6 @@
 /*
  * Light Gradient Tracking System
- * Uses 3 TSL2561 lux sensors to determine light gradient and points servo toward increasing light
+ * Uses an array of TSL2561 lux sensors (3 by default) to determine light gradient and points servo toward increasing light
  * Displays information on SSD1306 OLED display
  */
 
@@ -10,40 +10,341 @@
 #include "sensors.h"
 #include "gradient.h"
 #include "display.h"
-// #include "servo_control.h"
+#include "servo_control.h"
 #include "temperature.h"
 #include "ourSD.h"
+#include "flight_recorder.h"
+#include "telemetry.h"
+#include "calibration.h"
+#include "memory_stats.h"
+#include "network_uplink.h"
+#include "pipeline.h"
 // #include "date.h"
 #include "RTClib.h"
 
-// Global variables
-float currentAngle = 90.0;    // Starting angle
-float avgLux = 0.0;           // Average lux value
-float currentTemp = 25.0;     // Default temperature value
-float currentHumidity = 50.0; // Default humidity value
-
-uSD sdCard(false); // SD card object with debug mode enabled
+uSD sdCard; // SD card object (debug echo is SD_DEBUG in config.h)
 
 RTC_DS1307 rtc;
 
-// Timing variables
-unsigned long timeSensors = 0;
-unsigned long timeCalcs = 0;
-unsigned long timeTempHum = 0;
-unsigned long timeDisplay = 0;
-unsigned long timeSDFormat = 0;
-unsigned long timeSDWrite = 0;
-unsigned long timeSDLoop = 0;
-unsigned long timeTotalLoop = 0;
-unsigned long loopStartTime = 0;
-
-// Cycle counter for temperature/humidity readings
-uint8_t tempHumCounter = 0;
-const uint8_t TEMP_HUM_INTERVAL = 20; // Read temperature/humidity every 20 cycles
+// 'c' (blocks the loop) and 'r' (erases EEPROM) only run once confirmed with 'y', so a stray
+// byte on the serial line can't set them off
+char pendingCommand = 0;
+unsigned long pendingSince = 0;
+
+// Handle single-character commands from the serial monitor / host tools
+void handleSerialCommands()
+{
+    while (Serial.available() > 0)
+    {
+        char command = Serial.read();
+        if (command == '\r' || command == '\n')
+        {
+            continue; // Line endings from the serial monitor
+        }
+
+        // A request only stands until the next command
+        char pending = millis() - pendingSince < COMMAND_CONFIRM_MS ? pendingCommand : 0;
+        pendingCommand = 0;
+
+        switch (command)
+        {
+        case 'd': // Dump the flight recorder capture
+            dumpFlightRecorder();
+            break;
+        case 'a': // Re-arm the flight recorder
+            armFlightRecorder();
+            break;
+        case 't': // Trigger the flight recorder by hand
+            triggerFlightRecorder();
+            break;
+        case 'c': // Guided sensor calibration (needs 'y')
+            pendingCommand = command;
+            pendingSince = millis();
+            Serial.println(F("Send 'y' to start calibration (logging stops until it finishes)"));
+            break;
+        case 'r': // Clear the sensor calibration (needs 'y')
+            pendingCommand = command;
+            pendingSince = millis();
+            Serial.println(F("Send 'y' to erase the stored calibration"));
+            break;
+        case 'y': // Confirm 'c' or 'r'
+            if (pending == 'c')
+            {
+                runCalibration();
+            }
+            else if (pending == 'r')
+            {
+                resetCalibration();
+                saveCalibration();
+                Serial.println(F("Calibration cleared"));
+            }
+            break;
+        case 'm': // Memory report (text and telemetry)
+            printMemoryReport();
+            sendTelemetryMemory(readMemoryStats());
+            break;
+        }
+    }
+}
+
+// Header row of the CSV log
+void writeLogHeader()
+{
+    char header[200];
+    int len = snprintf(header, sizeof(header), "Datestamp, Time (ms)");
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        len += snprintf(header + len, sizeof(header) - len, ", Lux%u", i + 1);
+    }
+    snprintf(header + len, sizeof(header) - len, ", Angle (degrees), Temp (celcius), Humidity (Relative %%)\n");
+    sdCard.write_data(header);
+}
+
+// --- Pipeline stages ---
+// Each stage is a struct of static functions; the pipeline below picks which ones are
+// compiled into loop(). See pipeline.h.
+
+// Read every sensor (uncorrected)
+struct AcquireStage
+{
+    static void setup() { initSensors(); }
+    static inline void run(PipelineContext &ctx) { ctx.data = readRawSensors(); }
+};
+
+// Per-sensor gain/offset/curve correction
+struct CalibrateStage
+{
+    static void setup() { loadCalibration(); }
+    static inline void run(PipelineContext &ctx) { applyCalibration(ctx.data); }
+};
+
+// Extrapolate the sequential readings to a common instant
+struct AlignStage
+{
+    static void setup() {}
+    static inline void run(PipelineContext &ctx)
+    {
+        ctx.aligned = ctx.data; // Keep the calibrated readings for logging
+        alignSensorData(ctx.aligned);
+    }
+};
+
+// Average, gradient and angle
+struct SolveStage
+{
+    static void setup() {}
+    static inline void run(PipelineContext &ctx)
+    {
+        const SensorData &in = PIPELINE_ALIGN ? ctx.aligned : ctx.data;
+        ctx.avgLux = frameAverage(in);
+        calculateGradient(ctx.solver, in, ctx.gradientX, ctx.gradientY);
+        ctx.angle = gradientAngle(ctx.gradientX, ctx.gradientY);
+    }
+};
+
+// RAM capture at full sensor rate
+struct FlightRecorderStage
+{
+    static void setup() {}
+    static inline void run(PipelineContext &ctx) { recordFlightSample(ctx.data, ctx.angle, ctx.avgLux); }
+};
+
+// Temperature/humidity, only every Interval passes (the DHT read is slow)
+template <uint8_t Interval>
+struct TempHumStage
+{
+    static uint8_t counter;
+
+    static void setup()
+    {
+        initTemp();
+    }
+
+    static inline void run(PipelineContext &ctx)
+    {
+        if (counter == 0)
+        {
+            ctx.temp = tempInC();
+            ctx.humidity = humidity();
+        }
+        counter = (counter + 1) % Interval;
+    }
+};
+
+template <uint8_t Interval>
+uint8_t TempHumStage<Interval>::counter = 0;
+
+struct DisplayStage
+{
+    static void setup() { initDisplay(); }
+    static inline void run(PipelineContext &ctx)
+    {
+        updateDisplay(ctx.angle, ctx.avgLux, ctx.data, ctx.temp, ctx.humidity);
+    }
+};
+
+// Point the servo along the gradient (gradient angle 0 = servo centre)
+struct ServoStage
+{
+    static void setup() { initServo(); }
+    static inline void run(PipelineContext &ctx) { setServoAngle((int)(ctx.angle + 90)); }
+};
+
+// Build the CSV line; the RTC datestamp column is left empty without PIPELINE_RTC_STAMP
+struct LogFormatStage
+{
+    static void setup()
+    {
+        if (!PIPELINE_RTC_STAMP)
+        {
+            return;
+        }
+        if (!rtc.begin())
+        {
+            Serial.println("Couldn't find RTC");
+            Serial.flush();
+            while (1)
+                delay(10);
+        }
+        if (!rtc.isrunning())
+        {
+            Serial.println("RTC is NOT running, let's set the time!");
+            // When time needs to be set on a new device, or after a power loss, the
+            // following line sets the RTC to the date & time this sketch was compiled
+            rtc.adjust(DateTime(F(__DATE__), F(__TIME__)));
+        }
+    }
+
+    static inline void run(PipelineContext &ctx)
+    {
+        int len = 0;
+        if (PIPELINE_RTC_STAMP)
+        {
+            DateTime time = rtc.now();
+            len = snprintf(ctx.logLine, sizeof(ctx.logLine), "%s", time.timestamp(DateTime::TIMESTAMP_FULL).c_str());
+        }
+        ctx.logTime = millis();
+        len += snprintf(ctx.logLine + len, sizeof(ctx.logLine) - len, ", %lu", ctx.logTime);
+        for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+        {
+            len += snprintf(ctx.logLine + len, sizeof(ctx.logLine) - len, ",%.2f", ctx.data.lux[i]);
+        }
+        snprintf(ctx.logLine + len, sizeof(ctx.logLine) - len, ",%.2f,%.2f,%.2f\n", ctx.angle, ctx.temp, ctx.humidity);
+    }
+};
+
+struct LogWriteStage
+{
+    static void setup()
+    {
+        sdCard.setup();
+        writeLogHeader();
+    }
+
+    static inline void run(PipelineContext &ctx)
+    {
+        // Index key is the row's own Time column
+        sdCard.begin_record(ctx.logTime);
+        if (sdCard.write_data(ctx.logLine) != 0)
+        {
+            ctx.sdErrors++;
+        }
+    }
+};
+
+// Close/reopen the log so the data reaches the card
+struct LogFlushStage
+{
+    static void setup() {}
+    static inline void run(PipelineContext &) { sdCard.loop(); }
+};
+
+// Sample, timings and health frames over serial
+struct TelemetryStage
+{
+    static void setup() {}
+    static inline void run(PipelineContext &ctx)
+    {
+        ctx.timings.total = micros() - ctx.loopStart;
+        ctx.loops++;
+
+        TelemetrySample sample;
+        fillSample(ctx, sample);
+        sendTelemetrySample(sample);
+        sendTelemetryTimings(ctx.timings);
+
+        static unsigned long lastHealthTime = 0;
+        if (millis() - lastHealthTime > 1000) // Health counters once a second
+        {
+            sendTelemetryHealth(ctx.loops, ctx.sdErrors);
+            lastHealthTime = millis();
+        }
+    }
+
+    static inline void fillSample(const PipelineContext &ctx, TelemetrySample &sample)
+    {
+        sample.t_ms = millis();
+        for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+        {
+            sample.lux[i] = ctx.data.lux[i];
+        }
+        sample.angle = ctx.angle;
+        sample.temp = ctx.temp;
+        sample.humidity = ctx.humidity;
+    }
+};
+
+// Batched UDP uplink
+struct UplinkStage
+{
+    static void setup() { initUplink(); }
+    static inline void run(PipelineContext &ctx)
+    {
+        TelemetrySample sample;
+        TelemetryStage::fillSample(ctx, sample);
+        queueUplinkSample(sample);
+        serviceUplink();
+    }
+};
+
+// Hold each pass to at least UPDATE_DELAY ms
+struct PaceStage
+{
+    static void setup() {}
+    static inline void run(PipelineContext &ctx)
+    {
+        unsigned long elapsed = (micros() - ctx.loopStart) / 1000;
+        if (elapsed < (unsigned long)UPDATE_DELAY)
+        {
+            delay(UPDATE_DELAY - elapsed);
+        }
+    }
+};
+
+// acquire -> calibrate -> filter -> solve -> sinks, chosen by the PIPELINE_* flags in config.h
+typedef Pipeline<
+    Timed<AcquireStage, &TelemetryTimings::sensors>,
+    Optional<PIPELINE_CALIBRATE, CalibrateStage>,
+    Timed<Pipeline<Optional<PIPELINE_ALIGN, AlignStage>, SolveStage>, &TelemetryTimings::calcs>,
+    Optional<PIPELINE_FLIGHT_RECORDER, FlightRecorderStage>,
+    Optional<PIPELINE_TEMP_HUM, Timed<TempHumStage<TEMP_HUM_INTERVAL>, &TelemetryTimings::tempHum>>,
+    Optional<PIPELINE_DISPLAY, Timed<DisplayStage, &TelemetryTimings::display>>,
+    Optional<PIPELINE_SERVO, ServoStage>,
+    Optional<PIPELINE_SD_LOG, Timed<LogFormatStage, &TelemetryTimings::sdFormat>>,
+    Optional<PIPELINE_SD_LOG, Timed<LogWriteStage, &TelemetryTimings::sdWrite>>,
+    Optional<PIPELINE_SD_LOG, Timed<LogFlushStage, &TelemetryTimings::sdLoop>>,
+    Optional<PIPELINE_UPLINK, Timed<UplinkStage, &TelemetryTimings::uplink>>,
+    Optional<PIPELINE_TELEMETRY, TelemetryStage>,
+    Optional<PIPELINE_PACE, PaceStage>>
+    SamplePipeline;
+
+PipelineContext ctx;
 
 void setup()
 {
-    Serial.begin(115200);
+    paintStack(); // Before anything else touches the stack
+
+    Serial.begin(SERIAL_BAUD);
     while (!Serial)
         ; // Wait for serial connection on some boards
     Serial.println(F("Light Gradient Tracking System - Timing Enabled"));
@@ -51,122 +352,26 @@ void setup()
     Wire.setClock(400000); // Set I2C frequency to 400kHz (ensure components support this)
     Wire.begin();
 
-    // Initialize subsystems
-    initSensors();
-    // initServo();
-    initDisplay();
-    initTemp();
-    sdCard.setup();
-    sdCard.write_data("Datestamp, Time (ms), Lux1, Lux2, Lux3, Angle (degrees), Temp (celcius), Humidity (Relative %)\n");
+    // Initialize only the subsystems the pipeline uses
+    SamplePipeline::setup();
 
     // Take initial temperature and humidity readings
-    currentTemp = tempInC();
-    currentHumidity = humidity();
+    if (PIPELINE_TEMP_HUM)
+    {
+        ctx.temp = tempInC();
+        ctx.humidity = humidity();
+    }
 
     delay(100);
     Serial.println("Setup complete. Starting loop profiling...");
 
-    if (!rtc.begin())
-    {
-        Serial.println("Couldn't find RTC");
-        Serial.flush();
-        while (1)
-            delay(10);
-    }
-
-    if (!rtc.isrunning())
-    {
-        Serial.println("RTC is NOT running, let's set the time!");
-        // When time needs to be set on a new device, or after a power loss, the
-        // following line sets the RTC to the date & time this sketch was compiled
-        rtc.adjust(DateTime(F(__DATE__), F(__TIME__)));
-        // This line sets the RTC with an explicit date & time, for example to set
-        // January 21, 2014 at 3am you would call:
-        // rtc.adjust(DateTime(2014, 1, 21, 3, 0, 0));
-    }
+    // Memory use once everything is set up
+    printMemoryReport();
 }
 
 void loop()
 {
-    loopStartTime = micros(); // Start timing the entire loop
-
-    DateTime time = rtc.now();
-    sdCard.write_data(String(time.timestamp(DateTime::TIMESTAMP_FULL)).c_str());
-    sdCard.write_data(", ");
-    // --- Read sensor data ---
-    unsigned long start = micros();
-    SensorData data = readAllSensors();
-    timeSensors = micros() - start;
-
-    // --- Calculations ---
-    start = micros();
-    avgLux = (data.lux1 + data.lux2 + data.lux3) / 3.0;
-    float gradientX, gradientY;
-    calculateGradient(data.lux1, data.lux2, data.lux3, gradientX, gradientY);
-    float angle = atan2(gradientY, gradientX) * 180.0 / PI;
-    currentAngle = angle; // Store the raw angle for logging
-    timeCalcs = micros() - start;
-
-    // --- Read Temp/Humidity (only every TEMP_HUM_INTERVAL cycles) ---
-    start = micros();
-    if (tempHumCounter == 0)
-    {
-        // Only read temperature and humidity every TEMP_HUM_INTERVAL cycles
-        currentTemp = tempInC();
-        currentHumidity = humidity();
-    }
-    // Increment and wrap counter
-    tempHumCounter = (tempHumCounter + 1) % TEMP_HUM_INTERVAL;
-    timeTempHum = micros() - start;
-
-    // --- Update display ---
-    start = micros();
-    // Pass the raw angle to the display function
-    updateDisplay(angle, avgLux, data, currentTemp, currentHumidity);
-    timeDisplay = micros() - start;
-
-    // --- Format data for SD card ---
-    start = micros();
-    char buffer[200]; // Reduced buffer size - 1000 was excessive
-    snprintf(buffer, sizeof(buffer), "%ld,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n",
-             millis(), data.lux1, data.lux2, data.lux3, currentAngle, currentTemp, currentHumidity);
-    timeSDFormat = micros() - start;
-
-    // --- Write data to SD card ---
-    start = micros();
-    sdCard.write_data(buffer);
-    timeSDWrite = micros() - start;
-
-    // --- SD Card background tasks ---
-    start = micros();
-    sdCard.loop(); // Perform any background SD card operations (like flushing)
-    timeSDLoop = micros() - start;
-
-    timeTotalLoop = micros() - loopStartTime; // End timing the entire loop
-
-    // --- Print Timing Profile ---
-    // Print timings periodically to avoid flooding Serial
-    static unsigned long lastPrintTime = 0;
-    if (millis() - lastPrintTime > 1000) // Print every 1000ms (1 second)
-    {
-        Serial.print("Timings (us) - Total: ");
-        Serial.print(timeTotalLoop);
-        Serial.print(" | Sensors: ");
-        Serial.print(timeSensors);
-        Serial.print(" | Calcs: ");
-        Serial.print(timeCalcs);
-        Serial.print(" | TempHum: ");
-        Serial.print(timeTempHum);
-        Serial.print(" | Display: ");
-        Serial.print(timeDisplay);
-        Serial.print(" | SDFormat: ");
-        Serial.print(timeSDFormat);
-        Serial.print(" | SDWrite: ");
-        Serial.print(timeSDWrite);
-        Serial.print(" | SDLoop: ");
-        Serial.println(timeSDLoop);
-        Serial.print("Loop frequency (Hz): ");
-        Serial.println(1000000.0 / timeTotalLoop);
-        lastPrintTime = millis();
-    }
-}
\ No newline at end of file
+    ctx.loopStart = micros(); // Start timing the entire loop
+    SamplePipeline::run(ctx);
+    handleSerialCommands();
+}
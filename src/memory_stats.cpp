@@ -0,0 +1,100 @@
+/*
+ * Runtime memory instrumentation implementation
+ *
+ * Stack: the region between the linker's stack limit and the current stack pointer is
+ * painted with a pattern at boot. The deepest point ever reached is the first word above
+ * the limit that no longer holds the pattern.
+ * Heap: newlib's mallinfo() gives the arena size and how much of it is free.
+ */
+
+#include <malloc.h>
+#include <unistd.h>
+#include "memory_stats.h"
+
+// Stack and heap bounds from the core's linker script. Weak so a script without them still
+// links; the affected figures then read as 0.
+extern uint32_t __StackLimit __attribute__((weak));
+extern uint32_t __StackTop __attribute__((weak));
+extern uint8_t __HeapLimit __attribute__((weak));
+
+const uint32_t STACK_PAINT = 0xA5A5A5A5;
+const uint32_t STACK_PAINT_MARGIN = 64; // Bytes below the live stack pointer left unpainted
+
+bool stackPainted = false;
+
+// Current stack pointer
+static inline uint32_t *currentStackPointer()
+{
+    uint32_t *sp;
+    asm volatile("mov %0, sp" : "=r"(sp));
+    return sp;
+}
+
+void paintStack()
+{
+    if (&__StackLimit == nullptr || &__StackTop == nullptr)
+    {
+        return;
+    }
+
+    uint32_t *end = currentStackPointer() - STACK_PAINT_MARGIN / sizeof(uint32_t);
+    for (uint32_t *p = &__StackLimit; p < end; p++)
+    {
+        *p = STACK_PAINT;
+    }
+    stackPainted = true;
+}
+
+MemoryStats readMemoryStats()
+{
+    MemoryStats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    if (stackPainted)
+    {
+        uint32_t *p = &__StackLimit;
+        while (p < &__StackTop && *p == STACK_PAINT)
+        {
+            p++;
+        }
+        stats.stackSize = (uint32_t)((uint8_t *)&__StackTop - (uint8_t *)&__StackLimit);
+        stats.stackHighWater = (uint32_t)((uint8_t *)&__StackTop - (uint8_t *)p);
+    }
+
+    struct mallinfo info = mallinfo();
+    stats.heapArena = info.arena;
+    stats.heapUsed = info.uordblks;
+    stats.heapFree = info.fordblks;
+    stats.heapFreeBlocks = info.ordblks;
+
+    // The heap grows up towards its limit
+    uint8_t *heapTop = (uint8_t *)sbrk(0);
+    if (&__HeapLimit != nullptr && heapTop < &__HeapLimit)
+    {
+        stats.heapHeadroom = (uint32_t)(&__HeapLimit - heapTop);
+    }
+
+    return stats;
+}
+
+void printMemoryReport()
+{
+    MemoryStats stats = readMemoryStats();
+
+    Serial.print(F("Stack: "));
+    Serial.print(stats.stackHighWater);
+    Serial.print(F(" of "));
+    Serial.print(stats.stackSize);
+    Serial.println(F(" bytes used (high-water)"));
+
+    Serial.print(F("Heap: arena "));
+    Serial.print(stats.heapArena);
+    Serial.print(F(" | used "));
+    Serial.print(stats.heapUsed);
+    Serial.print(F(" | free "));
+    Serial.print(stats.heapFree);
+    Serial.print(F(" in "));
+    Serial.print(stats.heapFreeBlocks);
+    Serial.print(F(" blocks | headroom "));
+    Serial.println(stats.heapHeadroom);
+}
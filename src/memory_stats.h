@@ -0,0 +1,30 @@
+/*
+ * Runtime memory instrumentation - stack high-water mark and heap usage
+ */
+
+#ifndef MEMORY_STATS_H
+#define MEMORY_STATS_H
+
+#include <Arduino.h>
+
+struct MemoryStats
+{
+    uint32_t stackSize;      // Bytes reserved for the stack
+    uint32_t stackHighWater; // Most stack ever used since paintStack()
+    uint32_t heapArena;      // Bytes the heap has taken from the system
+    uint32_t heapUsed;       // Bytes in allocated blocks
+    uint32_t heapFree;       // Bytes in freed blocks inside the arena (reusable, but fragmented)
+    uint32_t heapFreeBlocks; // Number of free blocks inside the arena
+    uint32_t heapHeadroom;   // Bytes the heap can still grow by before hitting its limit
+};
+
+// Fill the unused stack with a known pattern; call first thing in setup()
+void paintStack();
+
+// Collect the current figures
+MemoryStats readMemoryStats();
+
+// Print a human-readable report to the serial port
+void printMemoryReport();
+
+#endif
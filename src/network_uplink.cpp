@@ -0,0 +1,183 @@
+/*
+ * Batched UDP telemetry implementation
+ *
+ * Samples are packed into fixed-size batches in a small ring of batch buffers. The loop
+ * only ever appends to the batch being filled; serviceUplink() hands at most one complete
+ * batch to the WiFi module per call, and no more often than UPLINK_MIN_INTERVAL_MS. When
+ * the network can't keep up the oldest waiting batch is discarded and counted, and the count
+ * rides along in every batch header so the host can tell board-side drops from network loss.
+ * Sequence numbers are only used by datagrams that actually went out, so a gap at the host is
+ * network loss and nothing else.
+ *
+ * Every WiFi call is an AT round trip to the WiFi module, so the loop makes at most one of
+ * them per UPLINK_MIN_INTERVAL_MS, and reconnecting never waits for the network to join.
+ */
+
+#include <WiFiS3.h>
+#include "network_uplink.h"
+#include "config.h"
+#include "crc16.h"
+
+static_assert(sizeof(UplinkHeader) + UPLINK_BATCH_SAMPLES * sizeof(TelemetrySample) + sizeof(uint16_t) <=
+                  UPLINK_MAX_DATAGRAM,
+              "UPLINK_BATCH_SAMPLES makes datagrams too large");
+
+struct UplinkBatch
+{
+    TelemetrySample samples[UPLINK_BATCH_SAMPLES];
+    uint16_t count;
+};
+
+UplinkBatch uplinkQueue[UPLINK_QUEUE_BATCHES];
+uint8_t uplinkFill = 0;    // Batch being filled
+uint8_t uplinkOldest = 0;  // Oldest complete batch waiting to be sent
+uint8_t uplinkWaiting = 0; // Complete batches waiting
+
+uint32_t uplinkSeq = 0;
+uint32_t uplinkBatchesSent = 0;
+uint32_t uplinkBatchesDropped = 0;
+
+WiFiUDP uplinkUdp;
+bool uplinkEnabled = false;
+bool uplinkOnline = false; // Joined and the UDP socket is open
+unsigned long lastUplinkService = 0;
+unsigned long lastUplinkConnect = 0;
+
+// WiFi.begin() sends the join command and then polls until it connects or the WiFi timeout
+// runs out. setup() waits for it; from the loop a zero timeout makes it return straight
+// away while the module keeps joining, and serviceUplink() picks up the result later.
+bool connectUplink(bool wait)
+{
+    lastUplinkConnect = millis();
+    WiFi.setTimeout(wait ? UPLINK_CONNECT_TIMEOUT_MS : 0);
+    return WiFi.begin(UPLINK_SSID, UPLINK_PASS) == WL_CONNECTED;
+}
+
+// Link is up: (re)open the socket
+void uplinkConnected()
+{
+    uplinkUdp.stop();
+    uplinkUdp.begin(UPLINK_PORT);
+    uplinkOnline = true;
+}
+
+void initUplink()
+{
+    if (UPLINK_SSID[0] == '\0')
+    {
+        Serial.println(F("Network uplink disabled (no SSID)"));
+        return;
+    }
+    if (WiFi.status() == WL_NO_MODULE)
+    {
+        Serial.println(F("WiFi module not found - network uplink disabled"));
+        return;
+    }
+
+    uplinkEnabled = true;
+    for (uint8_t i = 0; i < UPLINK_QUEUE_BATCHES; i++)
+    {
+        uplinkQueue[i].count = 0;
+    }
+
+    if (connectUplink(true))
+    {
+        uplinkConnected();
+        Serial.print(F("Network uplink connected, IP "));
+        Serial.println(WiFi.localIP());
+    }
+    else
+    {
+        Serial.println(F("Network uplink: WiFi connect failed, will retry"));
+    }
+}
+
+void queueUplinkSample(const TelemetrySample &sample)
+{
+    if (!uplinkEnabled)
+    {
+        return;
+    }
+
+    UplinkBatch &batch = uplinkQueue[uplinkFill];
+    batch.samples[batch.count++] = sample;
+    if (batch.count < UPLINK_BATCH_SAMPLES)
+    {
+        return;
+    }
+
+    // Batch complete; if every other slot is still waiting, sacrifice the oldest
+    if (uplinkWaiting == UPLINK_QUEUE_BATCHES - 1)
+    {
+        uplinkOldest = (uplinkOldest + 1) % UPLINK_QUEUE_BATCHES;
+        uplinkWaiting--;
+        uplinkBatchesDropped++; // Reported in the header; no sequence number is used up
+    }
+    uplinkWaiting++;
+    uplinkFill = (uplinkFill + 1) % UPLINK_QUEUE_BATCHES;
+    uplinkQueue[uplinkFill].count = 0;
+}
+
+void serviceUplink()
+{
+    if (!uplinkEnabled)
+    {
+        return;
+    }
+
+    // Nothing to send, or too soon after the last AT round trip
+    if (uplinkWaiting == 0 || millis() - lastUplinkService < UPLINK_MIN_INTERVAL_MS)
+    {
+        return;
+    }
+    lastUplinkService = millis();
+
+    // While offline, one status poll per interval (and a join request every UPLINK_RECONNECT_MS)
+    if (!uplinkOnline)
+    {
+        if (WiFi.status() == WL_CONNECTED)
+        {
+            uplinkConnected();
+        }
+        else if (millis() - lastUplinkConnect > UPLINK_RECONNECT_MS)
+        {
+            connectUplink(false);
+        }
+        return;
+    }
+
+    const UplinkBatch &batch = uplinkQueue[uplinkOldest];
+
+    UplinkHeader header;
+    memcpy(header.magic, "LTUP", 4);
+    header.version = UPLINK_VERSION;
+    header.channels = SENSOR_COUNT;
+    header.count = batch.count;
+    header.sampleSize = sizeof(TelemetrySample);
+    header.reserved = 0;
+    header.seq = uplinkSeq;
+    header.droppedBatches = uplinkBatchesDropped;
+
+    uint16_t bodyLen = batch.count * sizeof(TelemetrySample);
+    uint16_t crc = crc16((const uint8_t *)&header, sizeof(header));
+    crc = crc16Update(crc, (const uint8_t *)batch.samples, bodyLen);
+
+    uplinkUdp.beginPacket(IPAddress(UPLINK_HOST[0], UPLINK_HOST[1], UPLINK_HOST[2], UPLINK_HOST[3]), UPLINK_PORT);
+    uplinkUdp.write((const uint8_t *)&header, sizeof(header));
+    uplinkUdp.write((const uint8_t *)batch.samples, bodyLen);
+    uplinkUdp.write((const uint8_t *)&crc, sizeof(crc));
+    if (uplinkUdp.endPacket())
+    {
+        uplinkBatchesSent++;
+        uplinkSeq++;
+    }
+    else
+    {
+        // Not retried: counted as dropped, and the link is checked again before the next send
+        uplinkBatchesDropped++;
+        uplinkOnline = false;
+    }
+
+    uplinkOldest = (uplinkOldest + 1) % UPLINK_QUEUE_BATCHES;
+    uplinkWaiting--;
+}
@@ -0,0 +1,26 @@
+/*
+ * Batched UDP telemetry over the UNO R4 WiFi coprocessor
+ */
+
+#ifndef NETWORK_UPLINK_H
+#define NETWORK_UPLINK_H
+
+#include <Arduino.h>
+#include "telemetry.h"
+#include "uplink_format.h"
+
+// Counters for loss accounting on the board side
+extern uint32_t uplinkBatchesSent;
+extern uint32_t uplinkBatchesDropped;
+
+// Join the network and open the UDP socket (skipped when UPLINK_SSID is empty)
+void initUplink();
+
+// Add a sample to the batch being filled; never blocks
+void queueUplinkSample(const TelemetrySample &sample);
+
+// Send at most one queued batch if the rate limit allows (reconnecting without waiting if the
+// link is down); call once per loop
+void serviceUplink();
+
+#endif
@@ -6,11 +6,6 @@
 
 #include "ourSD.h"
 
-uSD::uSD(bool debugMode)
-{
-    this->debugMode = debugMode;
-}
-
 int uSD::setup()
 {
 
@@ -39,6 +34,60 @@ int uSD::setup()
     myFile = SD.open(filename, FILE_WRITE);
 
     // Serial.println("SD initialization done.");
+    return open_index();
+}
+
+int uSD::open_index()
+{
+    // Same number as the log, .idx instead of .csv
+    strcpy(indexname, filename);
+    strcpy(strrchr(indexname, '.'), ".idx");
+    recordCount = 0;
+
+    // Reopening after a failed log reopen: don't leak the old handle or its unflushed entries
+    if (indexFile)
+    {
+        indexFile.close();
+    }
+    // FILE_WRITE appends, so an N.idx left beside a deleted N.csv would keep its old entries
+    if (SD.exists(indexname))
+    {
+        SD.remove(indexname);
+    }
+    indexFile = SD.open(indexname, FILE_WRITE);
+    if (!indexFile)
+    {
+        return 1;
+    }
+
+    IndexHeader header;
+    memcpy(header.magic, "LIDX", 4);
+    header.version = INDEX_VERSION;
+    header.stride = LOG_INDEX_STRIDE;
+    indexFile.write((const uint8_t *)&header, sizeof(header));
+    indexDirty = true;
+    return 0;
+}
+
+int uSD::begin_record(uint32_t t_ms)
+{
+    if constexpr (debugMode)
+    {
+        return 1;
+    }
+    if (!myFile || !indexFile)
+    {
+        return 1;
+    }
+
+    if (recordCount++ % LOG_INDEX_STRIDE == 0)
+    {
+        IndexEntry entry;
+        entry.t_ms = t_ms;
+        entry.offset = myFile.size();
+        indexFile.write((const uint8_t *)&entry, sizeof(entry));
+        indexDirty = true;
+    }
     return 0;
 }
 
@@ -54,12 +103,19 @@ int uSD::loop()
 
         return setup();
     }
+
+    // Index entries are rare, so only flush when one was added
+    if (indexDirty && indexFile)
+    {
+        indexFile.flush();
+        indexDirty = false;
+    }
     return 0;
 }
 
 int uSD::write_data(const char *data)
 {
-    if (debugMode)
+    if constexpr (debugMode)
     {
         Serial.print(data);
         return 0;
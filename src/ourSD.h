@@ -9,20 +9,33 @@
 
 #include <SPI.h>
 #include <SD.h>
+#include "config.h"
+#include "log_index_format.h"
 
 class uSD
 {
 
     File myFile;
+    File indexFile;
     char filename[10];
+    char indexname[10];
+    uint32_t recordCount = 0;
+    bool indexDirty = false;
+
+    int open_index();
 
 public:
-    bool debugMode = false;
-    uSD(bool debugMode = false);
+    // Echo writes to serial instead of the card; fixed at compile time (SD_DEBUG in config.h)
+    // so the checks in the write path compile away
+    static constexpr bool debugMode = SD_DEBUG;
+
     int setup();
 
     int loop();
 
+    // Mark the start of a log record; every LOG_INDEX_STRIDE records this adds an index entry
+    int begin_record(uint32_t t_ms);
+
     int write_data(const char *data);
 
     // Overload to allow calling with an integer
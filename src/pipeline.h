@@ -0,0 +1,108 @@
+/*
+ * Compile-time sample pipeline
+ *
+ * A pipeline is a list of stage types fixed at compile time. Each stage is a struct with
+ * static setup() and run(PipelineContext &) functions. Pipeline<A, B, C>::run() expands to
+ * A::run(); B::run(); C::run(); with no function pointers or flags left at runtime, so
+ * everything inlines into loop(). Optional<false, Stage> swaps a stage for an empty one,
+ * and the disabled stage's code is not compiled into the firmware.
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "sensor_frame.h"
+#include "gradient.h"
+#include "telemetry_format.h"
+
+// Everything one pass of the pipeline produces, handed from stage to stage
+struct PipelineContext
+{
+    unsigned long loopStart; // micros() at the start of the pass
+
+    SensorData data;    // Calibrated readings (what gets logged)
+    SensorData aligned; // Readings aligned to a common instant (what gets solved)
+
+    GradientSolver solver; // Plane-fit weights for the current set of valid sensors
+
+    float avgLux = 0.0;
+    float gradientX = 0.0;
+    float gradientY = 0.0;
+    float angle = 90.0;
+
+    float temp = 25.0;     // Default temperature value
+    float humidity = 50.0; // Default humidity value
+
+    char logLine[200];
+    unsigned long logTime; // millis() written in the log row (also the index key)
+    uint32_t loops = 0;
+    uint32_t sdErrors = 0;
+
+    TelemetryTimings timings;
+};
+
+template <typename... Stages>
+struct Pipeline;
+
+template <>
+struct Pipeline<>
+{
+    static void setup() {}
+    static void run(PipelineContext &) {}
+};
+
+template <typename First, typename... Rest>
+struct Pipeline<First, Rest...>
+{
+    static void setup()
+    {
+        First::setup();
+        Pipeline<Rest...>::setup();
+    }
+
+    static inline __attribute__((always_inline)) void run(PipelineContext &ctx)
+    {
+        First::run(ctx);
+        Pipeline<Rest...>::run(ctx);
+    }
+};
+
+// A stage that does nothing; the stand-in for disabled stages
+struct NullStage
+{
+    static void setup() {}
+    static inline void run(PipelineContext &) {}
+};
+
+// Stage when Enabled, nothing otherwise
+template <bool Enabled, typename Stage>
+struct Optional : Stage
+{
+};
+
+template <typename Stage>
+struct Optional<false, Stage> : NullStage
+{
+};
+
+// Run a stage and store its duration (micros) in one of the telemetry timing slots.
+// With PIPELINE_TIMING off this is the bare stage.
+template <typename Stage, uint32_t TelemetryTimings::*Slot, bool Enabled = PIPELINE_TIMING>
+struct Timed : Stage
+{
+    static inline void run(PipelineContext &ctx)
+    {
+        unsigned long start = micros();
+        Stage::run(ctx);
+        ctx.timings.*Slot = micros() - start;
+    }
+};
+
+template <typename Stage, uint32_t TelemetryTimings::*Slot>
+struct Timed<Stage, Slot, false> : Stage
+{
+};
+
+#endif
@@ -0,0 +1,67 @@
+/*
+ * N-channel sensor frame - one lane per light sensor, laid out as structure-of-arrays
+ *
+ * Every per-sensor value lives in its own contiguous array so that averaging, calibration,
+ * alignment and the gradient solve are simple fixed-count loops the compiler can unroll.
+ * Kept free of Arduino dependencies so host tools can reuse it.
+ */
+
+#ifndef SENSOR_FRAME_H
+#define SENSOR_FRAME_H
+
+#include <stdint.h>
+#include "config.h"
+
+template <uint8_t N>
+struct SensorFrame
+{
+    static const uint8_t channels = N;
+
+    float lux[N];           // Lux per sensor
+    unsigned long t[N];     // Integration-midpoint timestamps (micros())
+    uint16_t broadband[N];  // Raw broadband counts
+    uint16_t ir[N];         // Raw infrared counts
+    bool valid[N];          // False when the sensor returned no reading or saturated
+};
+
+// TSL2561 calculateLux() reports clipping as this value
+const float LUX_SATURATED = 65536.0f;
+
+// Whether a raw reading can go into the fit: 0 is a failed read, and a saturated sensor
+// facing the source would swamp the others with a meaningless value
+inline bool rawLuxValid(float lux)
+{
+    return lux > 0 && lux < LUX_SATURATED;
+}
+
+// The frame used throughout the firmware
+typedef SensorFrame<SENSOR_COUNT> SensorData;
+
+// Average lux over the sensors that returned a reading (0 if none did)
+template <uint8_t N>
+inline float frameAverage(const SensorFrame<N> &frame)
+{
+    float sum = 0;
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < N; i++)
+    {
+        sum += frame.valid[i] ? frame.lux[i] : 0;
+        count += frame.valid[i];
+    }
+    return count ? sum / count : 0;
+}
+
+// Newest timestamp in the frame (rollover-safe)
+template <uint8_t N>
+inline unsigned long frameNewest(const SensorFrame<N> &frame)
+{
+    unsigned long newest = frame.t[0];
+    for (uint8_t i = 1; i < N; i++)
+    {
+        if ((long)(frame.t[i] - newest) > 0)
+            newest = frame.t[i];
+    }
+    return newest;
+}
+
+#endif
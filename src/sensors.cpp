@@ -2,40 +2,51 @@
  * Sensors implementation - Optimized for speed
  */
 
+#include <Wire.h>
 #include "sensors.h"
 #include "config.h"
+#include "calibration.h"
 
-// Create sensor objects with unique IDs
-Adafruit_TSL2561_Unified sensor1 = Adafruit_TSL2561_Unified(SENSOR1_ADDR, 12345);
-Adafruit_TSL2561_Unified sensor2 = Adafruit_TSL2561_Unified(SENSOR2_ADDR, 12346);
-Adafruit_TSL2561_Unified sensor3 = Adafruit_TSL2561_Unified(SENSOR3_ADDR, 12347);
+// Sensor objects, created in initSensors() from the address table in config.h
+Adafruit_TSL2561_Unified *sensors[SENSOR_COUNT];
 
-void initSensors()
+// Multiplexer channel currently routed (-1 = none / direct bus)
+int8_t currentMuxChannel = -1;
+
+void selectSensor(uint8_t index)
 {
-    // Initialize sensors
-    if (!sensor1.begin())
-    {
-        Serial.println(F("Sensor 1 not found - check wiring!"));
-        while (1)
-            ;
-    }
-    if (!sensor2.begin())
+    int8_t channel = SENSOR_MUX_CHANNEL[index];
+    if (channel == currentMuxChannel)
     {
-        Serial.println(F("Sensor 2 not found - check wiring!"));
-        while (1)
-            ;
+        return;
     }
-    if (!sensor3.begin())
+
+    // Main-bus sensors need every mux channel off, or a sensor behind the mux with the
+    // same address would answer too
+    Wire.beginTransmission(SENSOR_MUX_ADDR);
+    Wire.write(channel < 0 ? 0 : 1 << channel);
+    Wire.endTransmission();
+    currentMuxChannel = channel < 0 ? -1 : channel;
+}
+
+void initSensors()
+{
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
     {
-        Serial.println(F("Sensor 3 not found - check wiring!"));
-        while (1)
-            ;
-    }
+        sensors[i] = new Adafruit_TSL2561_Unified(SENSOR_ADDR[i], 12345 + i);
+
+        selectSensor(i);
+        if (!sensors[i]->begin())
+        {
+            Serial.print(F("Sensor "));
+            Serial.print(i + 1);
+            Serial.println(F(" not found - check wiring!"));
+            while (1)
+                ;
+        }
 
-    // Configure all sensors
-    configureSensor(sensor1);
-    configureSensor(sensor2);
-    configureSensor(sensor3);
+        configureSensor(*sensors[i]);
+    }
 
     Serial.println(F("All sensors initialized for fast reading"));
 }
@@ -58,32 +69,37 @@ void configureSensor(Adafruit_TSL2561_Unified &sensor)
     // --- END SPEED OPTIMIZATION ---
 }
 
-float readLux(Adafruit_TSL2561_Unified &sensor)
+float readLux(Adafruit_TSL2561_Unified &sensor, unsigned long &timestamp, uint16_t &broadband, uint16_t &ir)
 {
-    sensors_event_t event;
-    sensor.getEvent(&event);
+    // getLuminosity() powers the sensor up, waits out the integration time and reads it back,
+    // so the middle of the call is a good estimate of the integration midpoint
+    unsigned long start = micros();
+    sensor.getLuminosity(&broadband, &ir);
+    timestamp = start + (micros() - start) / 2;
 
-    // Avoid Serial printing in timing-critical code
-    if (event.light)
-    {
-        return event.light;
-    }
-    else
-    {
-        // Use a constant return value instead of Serial printing
-        // Serial.println(F("Error reading light value!"));
-        return 0;
-    }
+    // Same conversion getEvent() uses, but we keep the raw counts for the flight recorder
+    // (0 means the reading failed; saturation is reported as LUX_SATURATED)
+    return sensor.calculateLux(broadband, ir);
 }
 
-SensorData readAllSensors()
+SensorData readRawSensors()
 {
     SensorData data;
 
     // Read lux values from all sensors
-    data.lux1 = readLux(sensor1);
-    data.lux2 = readLux(sensor2);
-    data.lux3 = readLux(sensor3);
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        selectSensor(i);
+        data.lux[i] = readLux(*sensors[i], data.t[i], data.broadband[i], data.ir[i]);
+        data.valid[i] = rawLuxValid(data.lux[i]);
+    }
+
+    return data;
+}
 
+SensorData readAllSensors()
+{
+    SensorData data = readRawSensors();
+    applyCalibration(data);
     return data;
 }
\ No newline at end of file
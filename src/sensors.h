@@ -7,25 +7,24 @@
 
 #include <Adafruit_Sensor.h>
 #include <Adafruit_TSL2561_U.h>
-
-// Structure to hold sensor readings
-struct SensorData
-{
-    float lux1;
-    float lux2;
-    float lux3;
-};
+#include "sensor_frame.h"
 
 // Initialize the light sensors
 void initSensors();
 
+// Route the I2C bus to a sensor (only does anything for sensors behind the multiplexer)
+void selectSensor(uint8_t index);
+
 // Configure a single sensor
 void configureSensor(Adafruit_TSL2561_Unified &sensor);
 
-// Read lux value from a sensor
-float readLux(Adafruit_TSL2561_Unified &sensor);
+// Read lux value from a sensor, reporting when the sample was taken
+float readLux(Adafruit_TSL2561_Unified &sensor, unsigned long &timestamp, uint16_t &broadband, uint16_t &ir);
+
+// Read all sensors without applying the calibration
+SensorData readRawSensors();
 
-// Read all sensors and return the data
+// Read all sensors and return the calibrated data
 SensorData readAllSensors();
 
 #endif
\ No newline at end of file
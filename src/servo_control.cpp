@@ -8,29 +8,49 @@
 #include "servo_control.h"
 #include "config.h"
 
-// Create objects
-Adafruit_MotorShield AFMS = Adafruit_MotorShield();
-Servo trackingServo;
+// Created on first use rather than as globals, so with PIPELINE_SERVO off the functions
+// below are empty and neither object is constructed or linked into the firmware
+static Adafruit_MotorShield &motorShield()
+{
+    static Adafruit_MotorShield AFMS = Adafruit_MotorShield();
+    return AFMS;
+}
+
+static Servo &trackingServo()
+{
+    static Servo servo;
+    return servo;
+}
 
 void initServo()
 {
+    if (!PIPELINE_SERVO)
+    {
+        return;
+    }
+
     // Initialize motor shield
-    AFMS.begin();
+    motorShield().begin();
 
     // Attach servo to specified pin (corresponds to Servo1 on the shield)
-    trackingServo.attach(SERVO_PIN);
+    trackingServo().attach(SERVO_PIN);
 
     // Set to middle position
-    trackingServo.write(90);
+    trackingServo().write(90);
 
     Serial.println(F("Servo initialized"));
 }
 
 void setServoAngle(int angle)
 {
+    if (!PIPELINE_SERVO)
+    {
+        return;
+    }
+
     // Constrain angle to valid range
     angle = constrain(angle, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
 
     // Set servo position
-    trackingServo.write(angle);
+    trackingServo().write(angle);
 }
\ No newline at end of file
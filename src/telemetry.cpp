@@ -0,0 +1,111 @@
+/*
+ * Binary serial telemetry implementation
+ */
+
+#include "telemetry.h"
+#include "crc16.h"
+#include "cobs.h"
+
+uint32_t tlmFramesSent = 0;
+uint32_t tlmFramesDropped = 0;
+uint8_t tlmSeq = 0;
+
+// Bytes handed to Serial that the fallback estimate has not yet seen drain
+static uint32_t txBacklog = 0;
+static unsigned long txBacklogTime = 0;
+static bool txRoomReported = false;
+
+// Free space in the serial TX buffer. A core that implements availableForWrite() reports
+// room at boot, when the buffer is empty; if it never has, estimate the room instead from
+// the bytes written and the time they take to drain at SERIAL_BAUD (10 bits per byte).
+static int txRoom()
+{
+    int room = Serial.availableForWrite();
+    if (room > 0 || txRoomReported)
+    {
+        txRoomReported = true;
+        return room;
+    }
+
+    unsigned long now = micros();
+    uint32_t drained = (uint64_t)(now - txBacklogTime) * (SERIAL_BAUD / 10) / 1000000UL;
+    if (drained > 0)
+    {
+        txBacklog = drained < txBacklog ? txBacklog - drained : 0;
+        txBacklogTime = now;
+    }
+    return txBacklog < TLM_TX_BUFFER_FALLBACK ? TLM_TX_BUFFER_FALLBACK - txBacklog : 0;
+}
+
+bool sendTelemetry(TelemetryType type, const void *payload, uint16_t len)
+{
+    uint8_t frame[TLM_MAX_FRAME];
+    uint8_t encoded[TLM_MAX_ENCODED];
+
+    if (len > TLM_MAX_PAYLOAD)
+    {
+        tlmFramesDropped++;
+        return false;
+    }
+
+    // Build header + payload + CRC, then stuff it
+    TelemetryHeader header = {type, tlmSeq};
+    memcpy(frame, &header, sizeof(header));
+    memcpy(frame + sizeof(header), payload, len);
+    uint16_t frameLen = sizeof(header) + len;
+    uint16_t crc = crc16(frame, frameLen);
+    memcpy(frame + frameLen, &crc, sizeof(crc));
+    frameLen += sizeof(crc);
+
+    // Delimit on both sides so a frame following text or a flight recorder dump still decodes
+    encoded[0] = 0;
+    size_t encodedLen = 1 + cobsEncode(frame, frameLen, encoded + 1);
+    encoded[encodedLen++] = 0;
+
+    // Only hand the frame over if it fits entirely, so Serial.write() never waits
+    if (txRoom() < (int)encodedLen)
+    {
+        tlmFramesDropped++;
+        return false;
+    }
+
+    Serial.write(encoded, encodedLen);
+    txBacklog += encodedLen;
+    tlmSeq++;
+    tlmFramesSent++;
+    return true;
+}
+
+void sendTelemetrySample(const TelemetrySample &sample)
+{
+    sendTelemetry(TLM_SAMPLE, &sample, sizeof(sample));
+}
+
+void sendTelemetryTimings(const TelemetryTimings &timings)
+{
+    sendTelemetry(TLM_TIMINGS, &timings, sizeof(timings));
+}
+
+void sendTelemetryHealth(uint32_t loops, uint32_t sdErrors)
+{
+    TelemetryHealth health;
+    health.uptime_ms = millis();
+    health.loops = loops;
+    health.framesSent = tlmFramesSent;
+    health.framesDropped = tlmFramesDropped;
+    health.sdErrors = sdErrors;
+    sendTelemetry(TLM_HEALTH, &health, sizeof(health));
+}
+
+void sendTelemetryMemory(const MemoryStats &stats)
+{
+    TelemetryMemory memory;
+    memory.stackSize = stats.stackSize;
+    memory.stackHighWater = stats.stackHighWater;
+    memory.heapArena = stats.heapArena;
+    memory.heapUsed = stats.heapUsed;
+    memory.heapFree = stats.heapFree;
+    memory.heapFreeBlocks = stats.heapFreeBlocks;
+    memory.heapHeadroom = stats.heapHeadroom;
+    sendTelemetry(TLM_MEMORY, &memory, sizeof(memory));
+}
@@ -0,0 +1,28 @@
+/*
+ * Binary serial telemetry - COBS framed, CRC checked, never blocks the loop
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include "telemetry_format.h"
+#include "config.h"
+#include "memory_stats.h"
+
+static_assert(SENSOR_COUNT <= TLM_MAX_CHANNELS, "Telemetry sample cannot carry this many sensors");
+typedef TelemetrySampleN<SENSOR_COUNT> TelemetrySample;
+
+// Counters reported in TLM_HEALTH frames
+extern uint32_t tlmFramesSent;
+extern uint32_t tlmFramesDropped;
+
+// Queue one message on the serial port; dropped (and counted) if the TX buffer lacks room
+bool sendTelemetry(TelemetryType type, const void *payload, uint16_t len);
+
+void sendTelemetrySample(const TelemetrySample &sample);
+void sendTelemetryTimings(const TelemetryTimings &timings);
+void sendTelemetryHealth(uint32_t loops, uint32_t sdErrors);
+void sendTelemetryMemory(const MemoryStats &stats);
+
+#endif
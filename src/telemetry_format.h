@@ -0,0 +1,98 @@
+/*
+ * Binary telemetry message format, shared by the firmware and the host receiver
+ *
+ * Each frame on the wire is COBS-encoded and wrapped in 0x00 delimiter bytes. Decoded, a frame is
+ * a TelemetryHeader, the message payload, and a CRC-16 of header + payload.
+ * All fields are little-endian.
+ */
+
+#ifndef TELEMETRY_FORMAT_H
+#define TELEMETRY_FORMAT_H
+
+#include <stdint.h>
+
+enum TelemetryType : uint8_t
+{
+    TLM_SAMPLE = 1,  // One sensor sample and the derived values
+    TLM_TIMINGS = 2, // Per-stage loop timings
+    TLM_HEALTH = 3,  // Counters for spotting dropped data
+    TLM_MEMORY = 4,  // Stack high-water mark and heap usage
+};
+
+struct __attribute__((packed)) TelemetryHeader
+{
+    uint8_t type; // TelemetryType
+    uint8_t seq;  // Increments on every frame sent, so the host can count gaps
+};
+
+// Sample payload for N sensors; the host works out N from the payload length
+template <uint8_t N>
+struct __attribute__((packed)) TelemetrySampleN
+{
+    uint32_t t_ms;
+    float lux[N];
+    float angle;
+    float temp;
+    float humidity;
+};
+
+// Payload bytes of a sample that are not per-sensor
+const uint16_t TLM_SAMPLE_FIXED = sizeof(uint32_t) + 3 * sizeof(float);
+
+// Largest sensor array a sample can carry
+const uint8_t TLM_MAX_CHANNELS = 8;
+
+struct __attribute__((packed)) TelemetryTimings
+{
+    uint32_t total;
+    uint32_t sensors;
+    uint32_t calcs;
+    uint32_t tempHum;
+    uint32_t display;
+    uint32_t sdFormat;
+    uint32_t sdWrite;
+    uint32_t sdLoop;
+    uint32_t uplink; // Queueing and sending UDP batches
+};
+
+struct __attribute__((packed)) TelemetryHealth
+{
+    uint32_t uptime_ms;
+    uint32_t loops;
+    uint32_t framesSent;
+    uint32_t framesDropped; // Frames not sent because the TX buffer was full
+    uint32_t sdErrors;      // Failed SD writes
+};
+
+struct __attribute__((packed)) TelemetryMemory
+{
+    uint32_t stackSize;
+    uint32_t stackHighWater;
+    uint32_t heapArena;
+    uint32_t heapUsed;
+    uint32_t heapFree;
+    uint32_t heapFreeBlocks;
+    uint32_t heapHeadroom;
+};
+
+// Largest payload over every message type (add new messages here)
+constexpr uint16_t tlmMaxSize(uint16_t a) { return a; }
+
+template <typename... Sizes>
+constexpr uint16_t tlmMaxSize(uint16_t a, uint16_t b, Sizes... rest)
+{
+    return tlmMaxSize(a > b ? a : b, rest...);
+}
+
+const uint16_t TLM_MAX_PAYLOAD = tlmMaxSize(sizeof(TelemetrySampleN<TLM_MAX_CHANNELS>),
+                                            sizeof(TelemetryTimings),
+                                            sizeof(TelemetryHealth),
+                                            sizeof(TelemetryMemory));
+
+// Largest decoded frame: header + biggest payload + CRC
+const uint16_t TLM_MAX_FRAME = sizeof(TelemetryHeader) + TLM_MAX_PAYLOAD + sizeof(uint16_t);
+
+// COBS adds at most one byte per 254, plus the 0x00 delimiters either side
+const uint16_t TLM_MAX_ENCODED = TLM_MAX_FRAME + TLM_MAX_FRAME / 254 + 3;
+
+#endif
@@ -1,3 +1,11 @@
+/*
+ * DHT11 temperature/humidity sensor
+ * The definitions live in this header, so only main.cpp includes it
+ */
+
+#ifndef TEMPERATURE_H
+#define TEMPERATURE_H
+
 int DHpin = 4; // input/output pin
 byte dat[5];
 
@@ -53,4 +61,6 @@ float humidity()
     prepare_temp();
     float hum = dat[0] + dat[1] / 10.0; // Displays the integer bits of humidity;
     return hum;
-}
\ No newline at end of file
+}
+
+#endif
@@ -0,0 +1,30 @@
+/*
+ * UDP telemetry batch format, shared by the firmware and the host receiver
+ *
+ * One datagram = UplinkHeader, `count` samples of sampleSize bytes (the telemetry sample
+ * layout from telemetry_format.h), then a CRC-16 of everything before it. Little-endian.
+ */
+
+#ifndef UPLINK_FORMAT_H
+#define UPLINK_FORMAT_H
+
+#include <stdint.h>
+
+struct __attribute__((packed)) UplinkHeader
+{
+    char magic[4];           // "LTUP"
+    uint8_t version;         // UPLINK_VERSION
+    uint8_t channels;        // Sensors per sample
+    uint16_t count;          // Samples in this batch
+    uint16_t sampleSize;     // Bytes per sample
+    uint16_t reserved;
+    uint32_t seq;            // Batch sequence number, only used up by sent batches; gaps are network loss
+    uint32_t droppedBatches; // Batches the board discarded because its queue was full
+};
+
+const uint8_t UPLINK_VERSION = 1;
+
+// Keep datagrams well under a typical 1500 byte MTU
+const uint16_t UPLINK_MAX_DATAGRAM = 1400;
+
+#endif
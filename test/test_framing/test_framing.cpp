@@ -0,0 +1,135 @@
+/*
+ * Native tests for the telemetry framing: COBS (cobs.h) and CRC-16 (crc16.h)
+ *
+ * Run: pio test -e native
+ */
+
+#include <string.h>
+#include <unity.h>
+#include "cobs.h"
+#include "crc16.h"
+#include "telemetry_format.h"
+
+// Encode, check no 0x00 made it through, decode and compare
+void roundTrip(const uint8_t *in, size_t len)
+{
+    static uint8_t encoded[1200], decoded[1200];
+    TEST_ASSERT_TRUE(len + len / 254 + 1 <= sizeof(encoded));
+    size_t encodedLen = cobsEncode(in, len, encoded);
+    TEST_ASSERT_TRUE(encodedLen <= len + len / 254 + 1);
+    for (size_t i = 0; i < encodedLen; i++)
+    {
+        TEST_ASSERT_NOT_EQUAL(0, encoded[i]);
+    }
+    size_t decodedLen = cobsDecode(encoded, encodedLen, decoded);
+    TEST_ASSERT_EQUAL(len, decodedLen);
+    if (len > 0)
+    {
+        TEST_ASSERT_EQUAL_MEMORY(in, decoded, len);
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_crc16_check_value()
+{
+    // CRC-16/CCITT-FALSE check value
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, crc16((const uint8_t *)"123456789", 9));
+    // Feeding it in pieces gives the same result
+    uint16_t crc = crc16Update(CRC16_INIT, (const uint8_t *)"1234", 4);
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, crc16Update(crc, (const uint8_t *)"56789", 5));
+}
+
+void test_cobs_known_encoding()
+{
+    const uint8_t in[] = {0x11, 0x22, 0x00, 0x33};
+    const uint8_t expected[] = {0x03, 0x11, 0x22, 0x02, 0x33};
+    uint8_t out[8];
+    TEST_ASSERT_EQUAL(sizeof(expected), cobsEncode(in, sizeof(in), out));
+    TEST_ASSERT_EQUAL_MEMORY(expected, out, sizeof(expected));
+}
+
+void test_cobs_zeros()
+{
+    const uint8_t zero[] = {0};
+    roundTrip(zero, 1);
+    const uint8_t zeros[] = {0, 0, 0, 0};
+    roundTrip(zeros, sizeof(zeros));
+    const uint8_t ends[] = {0, 1, 2, 0};
+    roundTrip(ends, sizeof(ends));
+}
+
+void test_cobs_long_runs()
+{
+    // Runs either side of the 254-byte block limit, with and without a trailing zero
+    static uint8_t buf[1000];
+    const size_t lengths[] = {253, 254, 255, 508, 509, 1000};
+    for (size_t len : lengths)
+    {
+        for (size_t i = 0; i < len; i++)
+        {
+            buf[i] = (uint8_t)(i % 255 + 1);
+        }
+        roundTrip(buf, len);
+        buf[len - 1] = 0;
+        roundTrip(buf, len);
+    }
+}
+
+void test_cobs_rejects_truncated()
+{
+    const uint8_t in[] = {1, 2, 3, 4, 5};
+    uint8_t encoded[8], decoded[8];
+    size_t encodedLen = cobsEncode(in, sizeof(in), encoded);
+    TEST_ASSERT_EQUAL(0, cobsDecode(encoded, encodedLen - 1, decoded));
+    const uint8_t zeroCode[] = {0x02, 0x11, 0x00};
+    TEST_ASSERT_EQUAL(0, cobsDecode(zeroCode, sizeof(zeroCode), decoded));
+}
+
+void test_telemetry_frame_round_trip()
+{
+    // Header + payload + CRC, as telemetry.cpp sends it; zeros in the payload on purpose
+    TelemetryTimings timings = {};
+    timings.total = 2000;
+    timings.sensors = 1500;
+    timings.uplink = 256;
+
+    uint8_t frame[TLM_MAX_FRAME];
+    TelemetryHeader header = {TLM_TIMINGS, 7};
+    memcpy(frame, &header, sizeof(header));
+    memcpy(frame + sizeof(header), &timings, sizeof(timings));
+    size_t len = sizeof(header) + sizeof(timings);
+    uint16_t crc = crc16(frame, len);
+    memcpy(frame + len, &crc, sizeof(crc));
+    len += sizeof(crc);
+
+    uint8_t encoded[TLM_MAX_ENCODED];
+    uint8_t decoded[TLM_MAX_FRAME];
+    size_t encodedLen = cobsEncode(frame, len, encoded);
+    TEST_ASSERT_TRUE(encodedLen + 2 <= TLM_MAX_ENCODED); // Plus the delimiters
+    TEST_ASSERT_EQUAL(len, cobsDecode(encoded, encodedLen, decoded));
+
+    uint16_t received;
+    memcpy(&received, decoded + len - sizeof(received), sizeof(received));
+    TEST_ASSERT_EQUAL_HEX16(crc16(decoded, len - sizeof(received)), received);
+    TelemetryTimings out;
+    memcpy(&out, decoded + sizeof(header), sizeof(out));
+    TEST_ASSERT_EQUAL_MEMORY(&timings, &out, sizeof(out));
+
+    // A flipped bit is caught by the CRC
+    decoded[3] ^= 0x10;
+    TEST_ASSERT_NOT_EQUAL(crc16(decoded, len - sizeof(received)), received);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_crc16_check_value);
+    RUN_TEST(test_cobs_known_encoding);
+    RUN_TEST(test_cobs_zeros);
+    RUN_TEST(test_cobs_long_runs);
+    RUN_TEST(test_cobs_rejects_truncated);
+    RUN_TEST(test_telemetry_frame_round_trip);
+    return UNITY_END();
+}
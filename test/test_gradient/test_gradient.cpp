@@ -0,0 +1,117 @@
+/*
+ * Native tests for the least-squares gradient weights (gradient.cpp)
+ *
+ * Run: pio test -e native
+ */
+
+#include <unity.h>
+#include "gradient.h"
+
+// The plane through three readings, as the gradient was solved before the least-squares fit
+void closedForm(const float lux[3], float &gx, float &gy)
+{
+    const float(*p)[2] = SENSOR_POS;
+    float den = p[0][0] * (p[1][1] - p[2][1]) + p[1][0] * (p[2][1] - p[0][1]) + p[2][0] * (p[0][1] - p[1][1]);
+    gx = (lux[0] * (p[1][1] - p[2][1]) + lux[1] * (p[2][1] - p[0][1]) + lux[2] * (p[0][1] - p[1][1])) / den;
+    gy = (lux[0] * (p[2][0] - p[1][0]) + lux[1] * (p[0][0] - p[2][0]) + lux[2] * (p[1][0] - p[0][0])) / den;
+}
+
+SensorData frame(float l0, float l1, float l2)
+{
+    SensorData data = {};
+    const float lux[3] = {l0, l1, l2};
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        data.lux[i] = i < 3 ? lux[i] : 0;
+        data.valid[i] = i < 3;
+    }
+    return data;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_matches_closed_form()
+{
+    if (SENSOR_COUNT != 3)
+    {
+        TEST_IGNORE_MESSAGE("closed form only covers three sensors");
+    }
+    const float cases[][3] = {
+        {100, 120, 90}, {1, 1, 1}, {0.5f, 20000, 3}, {40000, 10, 10}, {250, 249, 251},
+    };
+    GradientSolver solver;
+    for (const auto &lux : cases)
+    {
+        float gx, gy, ex, ey;
+        calculateGradient(solver, frame(lux[0], lux[1], lux[2]), gx, gy);
+        closedForm(lux, ex, ey);
+        float scale = fabsf(lux[0]) + fabsf(lux[1]) + fabsf(lux[2]);
+        TEST_ASSERT_FLOAT_WITHIN(1e-5f * scale, ex, gx);
+        TEST_ASSERT_FLOAT_WITHIN(1e-5f * scale, ey, gy);
+    }
+}
+
+void test_known_values()
+{
+    if (SENSOR_COUNT != 3)
+    {
+        TEST_IGNORE_MESSAGE("values are for the default three sensors");
+    }
+    GradientSolver solver;
+    float gx, gy;
+    calculateGradient(solver, frame(100, 120, 90), gx, gy);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, -0.501253f, gx);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 3.157895f, gy);
+}
+
+void test_uniform_light_has_no_gradient()
+{
+    GradientSolver solver;
+    SensorData data = frame(500, 500, 500);
+    float gx, gy;
+    calculateGradient(solver, data, gx, gy);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0, gx);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0, gy);
+}
+
+void test_invalid_lane_gives_zero_and_recovers()
+{
+    if (SENSOR_COUNT != 3)
+    {
+        TEST_IGNORE_MESSAGE("with more sensors one failure still leaves a plane");
+    }
+    GradientSolver solver;
+    SensorData data = frame(100, 120, 90);
+    data.valid[1] = false;
+    data.lux[1] = 65536; // Whatever a failed lane holds must not leak into the result
+    float gx, gy;
+    calculateGradient(solver, data, gx, gy);
+    TEST_ASSERT_EQUAL_FLOAT(0, gx);
+    TEST_ASSERT_EQUAL_FLOAT(0, gy);
+
+    // Weights are re-solved once the sensor is back
+    calculateGradient(solver, frame(100, 120, 90), gx, gy);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, -0.501253f, gx);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 3.157895f, gy);
+}
+
+void test_raw_lux_valid()
+{
+    TEST_ASSERT_FALSE(rawLuxValid(0));
+    TEST_ASSERT_FALSE(rawLuxValid(-1));
+    TEST_ASSERT_FALSE(rawLuxValid(LUX_SATURATED));
+    TEST_ASSERT_TRUE(rawLuxValid(0.1f));
+    TEST_ASSERT_TRUE(rawLuxValid(40000));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_matches_closed_form);
+    RUN_TEST(test_known_values);
+    RUN_TEST(test_uniform_light_has_no_gradient);
+    RUN_TEST(test_invalid_lane_gives_zero_and_recovers);
+    RUN_TEST(test_raw_lux_valid);
+    return UNITY_END();
+}
@@ -0,0 +1,79 @@
+/*
+ * Native tests for the SD log index search (log_index_format.h)
+ *
+ * Run: pio test -e native
+ */
+
+#include <unity.h>
+#include "log_index_format.h"
+
+// Time and byte offset of every stride-th row of a log (two entries share a time on purpose)
+const IndexEntry entries[] = {
+    {1000, 100}, {33000, 2660}, {65000, 5220}, {65000, 7780}, {129000, 10340},
+};
+const size_t count = sizeof(entries) / sizeof(entries[0]);
+
+void setUp() {}
+void tearDown() {}
+
+void test_at_or_before_first_entry_starts_at_zero()
+{
+    TEST_ASSERT_EQUAL_UINT32(0, indexSeek(entries, count, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, indexSeek(entries, count, 1000));
+}
+
+void test_exact_match_starts_one_entry_early()
+{
+    // Rows just before an entry can carry the same time, so they have to be read too
+    TEST_ASSERT_EQUAL_UINT32(100, indexSeek(entries, count, 33000));
+    TEST_ASSERT_EQUAL_UINT32(7780, indexSeek(entries, count, 129000));
+}
+
+void test_between_entries()
+{
+    TEST_ASSERT_EQUAL_UINT32(100, indexSeek(entries, count, 32999));
+    TEST_ASSERT_EQUAL_UINT32(2660, indexSeek(entries, count, 33001));
+}
+
+void test_duplicate_times()
+{
+    // Both entries at 65000 may be preceded by rows at 65000; start before the first of them
+    TEST_ASSERT_EQUAL_UINT32(2660, indexSeek(entries, count, 65000));
+    TEST_ASSERT_EQUAL_UINT32(7780, indexSeek(entries, count, 65001));
+}
+
+void test_after_last_entry()
+{
+    TEST_ASSERT_EQUAL_UINT32(10340, indexSeek(entries, count, 0xFFFFFFFF));
+}
+
+void test_empty_index()
+{
+    TEST_ASSERT_EQUAL_UINT32(0, indexSeek(entries, 0, 5000));
+}
+
+void test_matches_linear_scan()
+{
+    for (uint32_t t = 0; t < 140000; t += 250)
+    {
+        uint32_t expected = 0;
+        for (size_t i = 0; i < count && entries[i].t_ms < t; i++)
+        {
+            expected = entries[i].offset;
+        }
+        TEST_ASSERT_EQUAL_UINT32(expected, indexSeek(entries, count, t));
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_at_or_before_first_entry_starts_at_zero);
+    RUN_TEST(test_exact_match_starts_one_entry_early);
+    RUN_TEST(test_between_entries);
+    RUN_TEST(test_duplicate_times);
+    RUN_TEST(test_after_last_entry);
+    RUN_TEST(test_empty_index);
+    RUN_TEST(test_matches_linear_scan);
+    return UNITY_END();
+}
@@ -0,0 +1,152 @@
+/*
+ * Flight recorder dump decoder (host side)
+ *
+ * Finds every "FREC" dump in a raw serial capture, checks its CRC and prints the
+ * samples as CSV. Text printed by the firmware around the dump is skipped.
+ *
+ * Build:   g++ -O2 -std=c++17 -o fr_decode tools/fr_decode.cpp
+ * Capture: stty -F /dev/ttyACM0 115200 raw -echo
+ *          cat /dev/ttyACM0 > capture.bin &   then   printf d > /dev/ttyACM0
+ * Decode:  ./fr_decode capture.bin > capture.csv
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "../src/crc16.h"
+#include "../src/flight_format.h"
+
+static const char *triggerName(uint8_t cause)
+{
+    switch (cause)
+    {
+    case FR_TRIGGER_LUX_STEP:
+        return "lux_step";
+    case FR_TRIGGER_ANGLE_JUMP:
+        return "angle_jump";
+    case FR_TRIGGER_MANUAL:
+        return "manual";
+    default:
+        return "none";
+    }
+}
+
+// Little-endian field readers for the variable-width sample layout
+static uint16_t readU16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t readU32(const uint8_t *p)
+{
+    return readU16(p) | ((uint32_t)readU16(p + 2) << 16);
+}
+
+static bool headerPrinted = false;
+
+// Decode one dump starting at `pos`; returns bytes consumed or 0 if it is not a valid dump
+static size_t decodeDump(const std::vector<uint8_t> &buf, size_t pos, int dumpIndex)
+{
+    FlightDumpHeader header;
+    if (pos + sizeof(header) > buf.size())
+        return 0;
+    memcpy(&header, &buf[pos], sizeof(header));
+
+    if (header.version != FR_DUMP_VERSION || header.channels == 0 ||
+        header.sampleSize != flightSampleSize(header.channels))
+    {
+        fprintf(stderr, "dump %d: unsupported version %u / sample size %u / %u channels\n",
+                dumpIndex, header.version, header.sampleSize, header.channels);
+        return 0;
+    }
+
+    size_t body = (size_t)header.count * header.sampleSize;
+    size_t total = sizeof(header) + body + sizeof(uint16_t);
+    if (pos + total > buf.size())
+    {
+        fprintf(stderr, "dump %d: truncated (%zu of %zu bytes)\n", dumpIndex, buf.size() - pos, total);
+        return 0;
+    }
+
+    const uint8_t *samples = &buf[pos + sizeof(header)];
+    if (crc16(&buf[pos], sizeof(header) + body) != readU16(samples + body))
+    {
+        fprintf(stderr, "dump %d: CRC mismatch\n", dumpIndex);
+        return 0;
+    }
+
+    fprintf(stderr, "dump %d: %u samples x %u sensors, trigger %s at index %d\n", dumpIndex, header.count,
+            header.channels, triggerName(header.triggerCause),
+            header.triggerIndex == 0xFFFF ? -1 : (int)header.triggerIndex);
+
+    // The column set depends on the sensor count, so the header comes from the first dump
+    uint8_t n = header.channels;
+    if (!headerPrinted)
+    {
+        printf("dump,index,t_us,t_rel_us");
+        for (uint8_t c = 1; c <= n; c++)
+            printf(",broadband%u,ir%u", c, c);
+        printf(",angle\n");
+        headerPrinted = true;
+    }
+
+    bool triggered = header.triggerIndex < header.count;
+    uint32_t triggerTime = triggered ? readU32(samples + header.triggerIndex * header.sampleSize) : 0;
+
+    for (uint16_t i = 0; i < header.count; i++)
+    {
+        const uint8_t *s = samples + i * header.sampleSize;
+        uint32_t t = readU32(s);
+        // Signed difference so samples before the trigger come out negative, even across a micros() wrap
+        long rel = triggered ? (long)(int32_t)(t - triggerTime) : 0;
+        printf("%d,%u,%u,%ld", dumpIndex, i, t, rel);
+        for (uint8_t c = 0; c < n; c++)
+            printf(",%u,%u", readU16(s + 4 + 2 * c), readU16(s + 4 + 2 * n + 2 * c));
+        printf(",%.2f\n", (int16_t)readU16(s + 4 + 4 * n) / 100.0);
+    }
+    return total;
+}
+
+int main(int argc, char **argv)
+{
+    FILE *in = stdin;
+    if (argc > 1 && strcmp(argv[1], "-") != 0)
+    {
+        in = fopen(argv[1], "rb");
+        if (!in)
+        {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    std::vector<uint8_t> buf;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0)
+        buf.insert(buf.end(), chunk, chunk + n);
+
+    int dumps = 0;
+    size_t pos = 0;
+    while (pos + 4 <= buf.size())
+    {
+        if (memcmp(&buf[pos], "FREC", 4) == 0)
+        {
+            size_t used = decodeDump(buf, pos, dumps);
+            if (used)
+            {
+                dumps++;
+                pos += used;
+                continue;
+            }
+        }
+        pos++;
+    }
+
+    if (dumps == 0)
+    {
+        fprintf(stderr, "no valid dumps found\n");
+        return 1;
+    }
+    return 0;
+}
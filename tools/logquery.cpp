@@ -0,0 +1,207 @@
+/*
+ * Time-range query over SD card logs (host side)
+ *
+ * Uses the N.idx sidecar written next to N.csv to jump straight to the records for a
+ * time window, so the cost depends on the size of the window and not on the size of the log.
+ * Both files are memory-mapped; nothing before the window is read.
+ *
+ * Build: g++ -O2 -std=c++17 -o logquery tools/logquery.cpp
+ * Usage: ./logquery 3.csv <start_ms> <end_ms>     print records with start <= Time (ms) <= end
+ *        ./logquery --build-index 3.csv [stride]  write 3.idx for a log that has none
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string>
+#include "../src/log_index_format.h"
+
+struct MappedFile
+{
+    const char *data = nullptr;
+    size_t size = 0;
+
+    bool open(const char *path)
+    {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            close(fd);
+            return false;
+        }
+        size = st.st_size;
+        if (size > 0)
+        {
+            void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                close(fd);
+                return false;
+            }
+            data = (const char *)p;
+            madvise(p, size, MADV_SEQUENTIAL);
+        }
+        close(fd);
+        return true;
+    }
+
+    ~MappedFile()
+    {
+        if (data)
+            munmap((void *)data, size);
+    }
+};
+
+static std::string indexPathFor(const char *csvPath)
+{
+    std::string path = csvPath;
+    size_t dot = path.rfind('.');
+    if (dot != std::string::npos && path.find('/', dot) == std::string::npos)
+        path.erase(dot);
+    return path + ".idx";
+}
+
+// Time (ms) is the second field: "<datestamp>, <millis>,<lux>..."; false for non-data lines
+static bool parseTime(const char *line, const char *end, uint32_t &t)
+{
+    const char *comma = (const char *)memchr(line, ',', end - line);
+    if (!comma)
+        return false;
+    const char *p = comma + 1;
+    while (p < end && *p == ' ')
+        p++;
+    if (p == end || *p < '0' || *p > '9')
+        return false;
+    uint32_t value = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+        value = value * 10 + (*p++ - '0');
+    t = value;
+    return true;
+}
+
+static int buildIndex(const char *csvPath, uint16_t stride)
+{
+    MappedFile csv;
+    if (!csv.open(csvPath))
+    {
+        perror(csvPath);
+        return 1;
+    }
+
+    std::string idxPath = indexPathFor(csvPath);
+    FILE *out = fopen(idxPath.c_str(), "wb");
+    if (!out)
+    {
+        perror(idxPath.c_str());
+        return 1;
+    }
+
+    IndexHeader header;
+    memcpy(header.magic, "LIDX", 4);
+    header.version = INDEX_VERSION;
+    header.stride = stride;
+    fwrite(&header, sizeof(header), 1, out);
+
+    size_t records = 0, entries = 0;
+    const char *end = csv.data + csv.size;
+    for (const char *line = csv.data; line < end;)
+    {
+        const char *nl = (const char *)memchr(line, '\n', end - line);
+        const char *lineEnd = nl ? nl : end;
+        uint32_t t;
+        if (parseTime(line, lineEnd, t) && records++ % stride == 0)
+        {
+            IndexEntry entry = {t, (uint32_t)(line - csv.data)};
+            fwrite(&entry, sizeof(entry), 1, out);
+            entries++;
+        }
+        line = lineEnd + 1;
+    }
+    fclose(out);
+    fprintf(stderr, "%s: %zu records, %zu index entries\n", idxPath.c_str(), records, entries);
+    return 0;
+}
+
+static int query(const char *csvPath, uint32_t start, uint32_t stop)
+{
+    MappedFile csv;
+    if (!csv.open(csvPath))
+    {
+        perror(csvPath);
+        return 1;
+    }
+
+    // Find where to start reading: the last index entry before `start`
+    size_t from = 0;
+    std::string idxPath = indexPathFor(csvPath);
+    MappedFile idx;
+    if (idx.open(idxPath.c_str()) && idx.size >= sizeof(IndexHeader) &&
+        memcmp(idx.data, "LIDX", 4) == 0)
+    {
+        IndexHeader header;
+        memcpy(&header, idx.data, sizeof(header));
+        if (header.version != INDEX_VERSION)
+        {
+            fprintf(stderr, "%s: unsupported index version %u\n", idxPath.c_str(), header.version);
+            return 1;
+        }
+
+        const IndexEntry *entries = (const IndexEntry *)(idx.data + sizeof(header));
+        size_t count = (idx.size - sizeof(header)) / sizeof(IndexEntry);
+        from = indexSeek(entries, count, start);
+        if (from >= csv.size)
+            from = 0; // Index doesn't match this log
+    }
+    else
+    {
+        fprintf(stderr, "%s: no index, scanning the whole log (use --build-index)\n", idxPath.c_str());
+    }
+
+    // Stream records from there until the window is passed
+    const char *end = csv.data + csv.size;
+    for (const char *line = csv.data + from; line < end;)
+    {
+        const char *nl = (const char *)memchr(line, '\n', end - line);
+        const char *lineEnd = nl ? nl + 1 : end;
+        uint32_t t;
+        if (parseTime(line, lineEnd, t))
+        {
+            if (t > stop)
+                break;
+            if (t >= start)
+                fwrite(line, 1, lineEnd - line, stdout);
+        }
+        line = lineEnd;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 3 && strcmp(argv[1], "--build-index") == 0)
+    {
+        long stride = argc > 3 ? strtol(argv[3], nullptr, 10) : 64;
+        if (stride < 1 || stride > 65535)
+        {
+            fprintf(stderr, "stride must be 1..65535\n");
+            return 1;
+        }
+        return buildIndex(argv[2], (uint16_t)stride);
+    }
+
+    if (argc != 4)
+    {
+        fprintf(stderr, "usage: %s <log.csv> <start_ms> <end_ms>\n"
+                        "       %s --build-index <log.csv> [stride]\n",
+                argv[0], argv[0]);
+        return 1;
+    }
+    return query(argv[1], strtoul(argv[2], nullptr, 10), strtoul(argv[3], nullptr, 10));
+}
@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+"""
+RAM/flash footprint report from a GNU ld map file.
+
+Sums every input section in the map by the module (object file or library archive) it
+came from, and shows where RAM and flash go. Hooked into PlatformIO as the `memreport`
+target (see pio_memreport.py):
+
+    pio run -t memreport
+
+or run directly on a map file:
+
+    python tools/memreport.py .pio/build/uno_r4_wifi/firmware.map [--by-library] [--top N]
+"""
+
+import argparse
+import os
+import re
+import sys
+
+# Output sections that take RAM only, RAM and flash (initialised data), or nothing on target
+RAM_ONLY = (".bss", ".noinit", ".heap", ".stack", ".stack_dummy")
+RAM_AND_FLASH = (".data",)
+NOT_LOADED = (".debug", ".comment", ".ARM.attributes", ".stab", ".note.gnu", ".gnu.attributes")
+
+SECTION_LINE = re.compile(r"^ (\S+)?\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+NAME_ONLY_LINE = re.compile(r"^ (\S+)$")
+OUTPUT_SECTION = re.compile(r"^(\.\S+|COMMON)\b")
+REGION_LINE = re.compile(r"^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(\s+\S+)?\s*$")
+
+
+def classify(output_section):
+    if output_section is None or output_section.startswith(NOT_LOADED):
+        return None
+    if output_section.startswith(RAM_ONLY):
+        return "ram"
+    if output_section.startswith(RAM_AND_FLASH):
+        return "both"
+    return "flash"
+
+
+def module_name(path, by_library):
+    path = path.strip()
+    archive = re.match(r"^(.*\.a)\((.*)\)$", path)
+    if archive:
+        lib = os.path.basename(archive.group(1))
+        return lib if by_library else "%s(%s)" % (lib, archive.group(2))
+    if by_library:
+        # PlatformIO builds each lib_deps entry under its own directory
+        parts = path.replace("\\", "/").split("/")
+        if "src" in parts:
+            return "src"
+        if len(parts) >= 2:
+            return parts[-2]
+    return os.path.basename(path).replace(".o", "")
+
+
+def parse_map(lines, by_library):
+    modules = {}
+    regions = {}
+    in_regions = False
+    in_map = False
+    output_section = None
+    pending_name = None
+
+    for line in lines:
+        line = line.rstrip("\n")
+
+        if line.startswith("Memory Configuration"):
+            in_regions = True
+            continue
+        if line.startswith("Linker script and memory map"):
+            in_regions = False
+            in_map = True
+            continue
+        if in_regions:
+            m = REGION_LINE.match(line)
+            if m and m.group(1) not in ("Name", "*default*"):
+                regions[m.group(1)] = (int(m.group(2), 16), int(m.group(3), 16))
+            continue
+        if not in_map:
+            continue
+
+        if line and not line.startswith(" "):
+            m = OUTPUT_SECTION.match(line)
+            if m:
+                output_section = m.group(1)
+            continue
+
+        # Long section names put the address/size/file on the following line
+        m = NAME_ONLY_LINE.match(line)
+        if m:
+            pending_name = m.group(1)
+            continue
+
+        m = SECTION_LINE.match(line)
+        if not m:
+            pending_name = None
+            continue
+        name = m.group(1) or pending_name
+        pending_name = None
+        size = int(m.group(3), 16)
+        source = m.group(4)
+        if name is None or name == "*fill*" or size == 0 or not re.search(r"\.(o|obj)\)?$", source):
+            continue
+
+        kind = classify(output_section)
+        if kind is None:
+            continue
+        entry = modules.setdefault(module_name(source, by_library), {"flash": 0, "ram": 0})
+        if kind in ("flash", "both"):
+            entry["flash"] += size
+        if kind in ("ram", "both"):
+            entry["ram"] += size
+
+    return modules, regions
+
+
+def region_size(regions, *names):
+    for name in names:
+        for region, (_, length) in regions.items():
+            if region.upper() == name:
+                return length
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("map", help="linker map file")
+    parser.add_argument("--by-library", action="store_true", help="group by library instead of object file")
+    parser.add_argument("--top", type=int, default=0, help="only show the N largest modules")
+    args = parser.parse_args()
+
+    try:
+        with open(args.map, errors="replace") as f:
+            modules, regions = parse_map(f, args.by_library)
+    except OSError as e:
+        sys.exit("memreport: %s" % e)
+
+    if not modules:
+        sys.exit("memreport: no sections found in %s - was it linked with -Wl,-Map?" % args.map)
+
+    rows = sorted(modules.items(), key=lambda kv: (kv[1]["ram"], kv[1]["flash"]), reverse=True)
+    if args.top:
+        rows = rows[: args.top]
+
+    width = max(len(name) for name, _ in rows)
+    print("%-*s %10s %10s" % (width, "Module", "RAM", "Flash"))
+    print("-" * (width + 22))
+    for name, entry in rows:
+        print("%-*s %10d %10d" % (width, name, entry["ram"], entry["flash"]))
+    print("-" * (width + 22))
+
+    total_ram = sum(e["ram"] for e in modules.values())
+    total_flash = sum(e["flash"] for e in modules.values())
+    print("%-*s %10d %10d" % (width, "Total", total_ram, total_flash))
+
+    ram_size = region_size(regions, "RAM")
+    flash_size = region_size(regions, "FLASH")
+    if ram_size:
+        print("RAM:   %d of %d bytes (%.1f%%), %d free for stack/heap growth"
+              % (total_ram, ram_size, 100.0 * total_ram / ram_size, ram_size - total_ram))
+    if flash_size:
+        print("Flash: %d of %d bytes (%.1f%%)" % (total_flash, flash_size, 100.0 * total_flash / flash_size))
+
+
+if __name__ == "__main__":
+    main()
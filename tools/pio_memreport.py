@@ -0,0 +1,17 @@
+"""
+PlatformIO hook: link with a map file and add the `memreport` target.
+
+    pio run -t memreport
+"""
+
+Import("env")  # noqa: F821 - provided by PlatformIO
+
+env.Append(LINKFLAGS=["-Wl,-Map,${BUILD_DIR}/${PROGNAME}.map"])  # noqa: F821
+
+env.AddCustomTarget(  # noqa: F821
+    name="memreport",
+    dependencies="$BUILD_DIR/${PROGNAME}.elf",
+    actions='"$PYTHONEXE" "$PROJECT_DIR/tools/memreport.py" "$BUILD_DIR/${PROGNAME}.map"',
+    title="Memory report",
+    description="RAM and flash use per module from the linker map",
+)
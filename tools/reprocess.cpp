@@ -0,0 +1,479 @@
+/*
+ * Parallel offline reprocessing of SD card logs (host side)
+ *
+ * Re-runs the firmware's gradient solve and angle math over archived N.csv logs, so a change
+ * to SENSOR_POS, SENSOR_COUNT or the calibration can be applied to old data. The firmware
+ * sources (src/gradient.cpp, src/config.h, the calibration kernel) are compiled in unchanged,
+ * so edit config.h and rebuild to reprocess with new geometry.
+ *
+ * Logs hold calibrated lux, so recalibrating needs the calibration the log was written with
+ * as well as the new one: --cal undoes the first (inverting the kernel's quadratic) and then
+ * applies the second. The coefficients are the ones the 'c' command prints; a board that was
+ * never calibrated logs with the identity ("1 0 0" per sensor). Lux is logged to two
+ * decimals, so values recovered this way carry that rounding.
+ *
+ * Not replayed: the firmware's skew alignment (alignSensorData). The log has one time per
+ * row and not the per-sensor read times it extrapolates from, so the angle here is solved
+ * on the readings as logged. It matches the firmware's when the light is steady and can
+ * differ while the source moves. The only other state is the gradient weight cache, and each
+ * thread has its own (GradientSolver), so chunks are independent.
+ *
+ * The log is memory-mapped and split at line boundaries into one range per thread. Each
+ * thread parses its range in place (no per-line allocation) into a fixed-size block buffer
+ * and writes every block out as it fills: the first range straight into the output file, the
+ * others into unlinked temp files next to it, which are then copied into place in parallel
+ * (copy_file_range, so the data stays in the kernel). Memory use does not grow with the log.
+ *
+ * Output has the log's columns with Angle recomputed (and lux recalibrated if --cal is
+ * given), plus GradientX and GradientY. Rebuild the time index afterwards with
+ * `logquery --build-index`.
+ *
+ * Build: g++ -O3 -std=c++17 -pthread -Isrc -o reprocess tools/reprocess.cpp src/gradient.cpp
+ * Usage: ./reprocess [-j threads] [--cal logged.txt new.txt] <in.csv> <out.csv>
+ *        each cal file holds one "gain offset curve" line per sensor
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gradient.h"
+#include "calibration_kernel.h"
+
+SensorCalibration calibration;       // New calibration, applied by the kernel
+static SensorCalibration loggedCalibration; // Calibration the log was written with
+static bool recalibrate = false;
+
+// Output is written in blocks of this size; a line that could not fit in one is dropped
+const size_t OUT_BLOCK = 1 << 20;
+
+// First write error seen by any thread (errno value, 0 = none)
+static std::atomic<int> writeError(0);
+
+static void recordWriteError(int err)
+{
+    int none = 0;
+    writeError.compare_exchange_strong(none, err ? err : EIO);
+}
+
+// Log columns: Datestamp, Time (ms), Lux1..N, Angle, Temp, Humidity
+const int FIELD_TIME = 1;
+const int FIELD_LUX = 2;
+const int FIELD_ANGLE = FIELD_LUX + SENSOR_COUNT;
+const int FIELD_TEMP = FIELD_ANGLE + 1;
+const int FIELD_COUNT = FIELD_TEMP + 2;
+
+struct Chunk
+{
+    const char *begin;
+    const char *end;
+    bool first; // Holds the start of the file (and the header line)
+    int fd;     // Where the output goes: the output file for the first chunk, else a temp file
+    size_t written = 0;
+    size_t rows = 0;
+    size_t skipped = 0;
+};
+
+// Write all of buf at offset; false (and the error recorded) on failure
+static bool pwriteAll(int fd, const char *buf, size_t len, off_t at)
+{
+    while (len > 0)
+    {
+        ssize_t n = pwrite(fd, buf, len, at);
+        if (n <= 0)
+        {
+            recordWriteError(n < 0 ? errno : EIO);
+            return false;
+        }
+        buf += n;
+        at += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Parse a %.2f style number (optional sign, digits, fraction); false if the field isn't one
+static bool parseNumber(const char *p, const char *end, float &value)
+{
+    while (p < end && *p == ' ')
+        p++;
+    bool negative = p < end && *p == '-';
+    if (negative || (p < end && *p == '+'))
+        p++;
+    if (p == end || ((*p < '0' || *p > '9') && *p != '.'))
+        return false;
+
+    double v = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+        v = v * 10 + (*p++ - '0');
+    if (p < end && *p == '.')
+    {
+        double scale = 0.1;
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, scale *= 0.1)
+            v += (*p - '0') * scale;
+    }
+    while (p < end && *p == ' ')
+        p++;
+    if (p != end)
+        return false;
+    value = (float)(negative ? -v : v);
+    return true;
+}
+
+// Append a value with two decimals, matching the firmware's "%.2f"
+static char *appendFixed2(char *p, float value)
+{
+    if (!isfinite(value) || fabsf(value) > 1e15f)
+        return p + sprintf(p, "%.2f", value);
+
+    long long scaled = llround((double)value * 100.0);
+    if (scaled < 0)
+    {
+        *p++ = '-';
+        scaled = -scaled;
+    }
+    char digits[24];
+    int n = 0;
+    long long whole = scaled / 100;
+    do
+    {
+        digits[n++] = '0' + whole % 10;
+        whole /= 10;
+    } while (whole);
+    while (n)
+        *p++ = digits[--n];
+    *p++ = '.';
+    *p++ = '0' + (scaled / 10) % 10;
+    *p++ = '0' + scaled % 10;
+    return p;
+}
+
+static char *appendBytes(char *p, const char *begin, const char *end)
+{
+    memcpy(p, begin, end - begin);
+    return p + (end - begin);
+}
+
+static char *appendHeader(char *p)
+{
+    p += sprintf(p, "Datestamp, Time (ms)");
+    for (int i = 0; i < SENSOR_COUNT; i++)
+        p += sprintf(p, ", Lux%d", i + 1);
+    p += sprintf(p, ", Angle (degrees), Temp (celcius), Humidity (Relative %%), GradientX, GradientY\n");
+    return p;
+}
+
+// Undo the logged calibration: solve curve * x^2 + gain * x + offset = lux for the raw x.
+// Written as 2d / (gain + sqrt(...)) so it stays exact as curve goes to 0.
+static float uncalibrateLux(float lux, int sensor)
+{
+    if (lux == 0)
+        return 0; // Failed reading
+    float d = lux - loggedCalibration.offset[sensor];
+    float disc = loggedCalibration.gain[sensor] * loggedCalibration.gain[sensor] +
+                 4 * loggedCalibration.curve[sensor] * d;
+    float denom = disc >= 0 ? loggedCalibration.gain[sensor] + sqrtf(disc) : 0;
+    float raw = denom != 0 ? 2 * d / denom : 0;
+    return raw > 0 ? raw : 0;
+}
+
+static void processChunk(Chunk &chunk)
+{
+    const char *fieldStart[FIELD_COUNT + 1];
+    GradientSolver solver; // Per thread: the weight cache changes with the set of valid sensors
+    std::unique_ptr<char[]> block(new char[OUT_BLOCK]);
+    size_t blockLen = 0;
+
+    for (const char *line = chunk.begin; line < chunk.end;)
+    {
+        const char *nl = (const char *)memchr(line, '\n', chunk.end - line);
+        const char *lineEnd = nl ? nl : chunk.end;
+        const char *next = nl ? nl + 1 : chunk.end;
+        if (lineEnd > line && lineEnd[-1] == '\r')
+            lineEnd--;
+
+        // Worst case the line grows by a formatted number per rewritten column
+        size_t need = (lineEnd - line) + 32 * (SENSOR_COUNT + 4) + 256;
+        if (need > OUT_BLOCK)
+        {
+            chunk.skipped++; // Not a log record
+            line = next;
+            continue;
+        }
+        if (OUT_BLOCK - blockLen < need)
+        {
+            if (!pwriteAll(chunk.fd, block.get(), blockLen, chunk.written))
+                return;
+            chunk.written += blockLen;
+            blockLen = 0;
+        }
+        char *out = block.get() + blockLen;
+
+        // Split into fields without copying
+        int fields = 0;
+        fieldStart[fields++] = line;
+        for (const char *p = line; p < lineEnd && fields <= FIELD_COUNT; p++)
+            if (*p == ',')
+                fieldStart[fields++] = p + 1;
+        if (fields == FIELD_COUNT)
+            fieldStart[fields] = lineEnd + 1; // So field i always ends at fieldStart[i + 1] - 1
+
+        SensorData data;
+        float time;
+        bool ok = fields == FIELD_COUNT &&
+                  parseNumber(fieldStart[FIELD_TIME], fieldStart[FIELD_TIME + 1] - 1, time);
+        for (int i = 0; ok && i < SENSOR_COUNT; i++)
+        {
+            ok = parseNumber(fieldStart[FIELD_LUX + i], fieldStart[FIELD_LUX + i + 1] - 1, data.lux[i]);
+            // Saturation can only be recognised on raw readings, i.e. with --cal
+            if (recalibrate)
+                data.lux[i] = uncalibrateLux(data.lux[i], i);
+            data.valid[i] = recalibrate ? rawLuxValid(data.lux[i]) : data.lux[i] > 0;
+        }
+
+        if (!ok)
+        {
+            // The first line of a log is its header; anything else that doesn't parse is dropped
+            if (chunk.first && line == chunk.begin)
+                out = appendHeader(out);
+            else
+                chunk.skipped++;
+            blockLen = out - block.get();
+            line = next;
+            continue;
+        }
+
+        if (recalibrate)
+            applyCalibration(data);
+        float gradientX, gradientY;
+        calculateGradient(solver, data, gradientX, gradientY);
+        float angle = gradientAngle(gradientX, gradientY);
+
+        // Datestamp and time as logged
+        out = appendBytes(out, fieldStart[0], fieldStart[FIELD_LUX]);
+        for (int i = 0; i < SENSOR_COUNT; i++)
+        {
+            if (recalibrate)
+                out = appendFixed2(out, data.lux[i]);
+            else
+                out = appendBytes(out, fieldStart[FIELD_LUX + i], fieldStart[FIELD_LUX + i + 1] - 1);
+            *out++ = ',';
+        }
+        out = appendFixed2(out, angle);
+        *out++ = ',';
+        out = appendBytes(out, fieldStart[FIELD_TEMP], lineEnd); // Temp and humidity as logged
+        *out++ = ',';
+        out = appendFixed2(out, gradientX);
+        *out++ = ',';
+        out = appendFixed2(out, gradientY);
+        *out++ = '\n';
+
+        blockLen = out - block.get();
+        chunk.rows++;
+        line = next;
+    }
+
+    if (pwriteAll(chunk.fd, block.get(), blockLen, chunk.written))
+        chunk.written += blockLen;
+}
+
+// Copy a finished temp file into the output at its final offset
+static void placeChunk(const Chunk &chunk, int outFd, off_t at)
+{
+    loff_t in = 0, out = at;
+    size_t left = chunk.written;
+    while (left > 0)
+    {
+        ssize_t n = copy_file_range(chunk.fd, &in, outFd, &out, left, 0);
+        if (n <= 0)
+            break;
+        left -= n;
+    }
+    if (left == 0)
+        return;
+
+    // Filesystem without copy_file_range: go through a bounded buffer instead
+    std::unique_ptr<char[]> block(new char[OUT_BLOCK]);
+    while (left > 0)
+    {
+        ssize_t n = pread(chunk.fd, block.get(), left < OUT_BLOCK ? left : OUT_BLOCK, in);
+        if (n <= 0)
+        {
+            recordWriteError(n < 0 ? errno : EIO);
+            return;
+        }
+        if (!pwriteAll(outFd, block.get(), n, out))
+            return;
+        in += n;
+        out += n;
+        left -= n;
+    }
+}
+
+static bool loadCalibrationFile(const char *path, SensorCalibration &cal)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+    {
+        perror(path);
+        return false;
+    }
+    for (int i = 0; i < SENSOR_COUNT; i++)
+    {
+        if (fscanf(f, "%f %f %f", &cal.gain[i], &cal.offset[i], &cal.curve[i]) != 3)
+        {
+            fprintf(stderr, "%s: expected %d lines of \"gain offset curve\"\n", path, SENSOR_COUNT);
+            fclose(f);
+            return false;
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned threads = std::thread::hardware_concurrency();
+    const char *inPath = nullptr;
+    const char *outPath = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+            threads = (unsigned)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--cal") == 0 && i + 2 < argc)
+        {
+            if (!loadCalibrationFile(argv[++i], loggedCalibration) || !loadCalibrationFile(argv[++i], calibration))
+                return 1;
+            recalibrate = true;
+        }
+        else if (!inPath)
+            inPath = argv[i];
+        else if (!outPath)
+            outPath = argv[i];
+    }
+    if (!inPath || !outPath)
+    {
+        fprintf(stderr, "usage: %s [-j threads] [--cal logged.txt new.txt] <in.csv> <out.csv>\n", argv[0]);
+        return 1;
+    }
+    if (threads == 0)
+        threads = 1;
+
+    int inFd = open(inPath, O_RDONLY);
+    struct stat st;
+    if (inFd < 0 || fstat(inFd, &st) != 0)
+    {
+        perror(inPath);
+        return 1;
+    }
+    size_t size = st.st_size;
+    const char *data = nullptr;
+    if (size > 0)
+    {
+        void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, inFd, 0);
+        if (p == MAP_FAILED)
+        {
+            perror("mmap");
+            return 1;
+        }
+        madvise(p, size, MADV_SEQUENTIAL | MADV_WILLNEED);
+        data = (const char *)p;
+    }
+    close(inFd);
+
+    auto start = std::chrono::steady_clock::now();
+
+    int outFd = open(outPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (outFd < 0)
+    {
+        perror(outPath);
+        return 1;
+    }
+
+    // Split at line boundaries, one chunk per thread
+    std::vector<Chunk> chunks(threads);
+    const char *pos = data;
+    const char *end = data + size;
+    for (unsigned t = 0; t < threads; t++)
+    {
+        const char *cut = t + 1 == threads ? end : data + size * (t + 1) / threads;
+        if (cut < pos)
+            cut = pos;
+        if (cut < end)
+        {
+            const char *nl = (const char *)memchr(cut, '\n', end - cut);
+            cut = nl ? nl + 1 : end;
+        }
+        chunks[t].begin = pos;
+        chunks[t].end = cut;
+        chunks[t].first = t == 0;
+        pos = cut;
+
+        // Only the first chunk's offset is known up front; the rest go to temp files on the
+        // same filesystem (so they can be copied into place without leaving the kernel)
+        if (t == 0)
+        {
+            chunks[t].fd = outFd;
+            continue;
+        }
+        std::string tmpPath = std::string(outPath) + ".part" + std::to_string(t);
+        chunks[t].fd = open(tmpPath.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (chunks[t].fd < 0)
+        {
+            perror(tmpPath.c_str());
+            return 1;
+        }
+        unlink(tmpPath.c_str()); // Gone as soon as it is closed, even if we crash
+    }
+
+    std::vector<std::thread> workers;
+    for (auto &chunk : chunks)
+        workers.emplace_back(processChunk, std::ref(chunk));
+    for (auto &w : workers)
+        w.join();
+
+    // Lay the chunks out back to back and copy them into place concurrently
+    size_t total = 0, rows = 0, skipped = 0;
+    std::vector<size_t> offsets;
+    for (auto &chunk : chunks)
+    {
+        offsets.push_back(total);
+        total += chunk.written;
+        rows += chunk.rows;
+        skipped += chunk.skipped;
+    }
+
+    workers.clear();
+    for (size_t t = 1; t < chunks.size() && writeError == 0; t++)
+        workers.emplace_back(placeChunk, std::cref(chunks[t]), outFd, (off_t)offsets[t]);
+    for (auto &w : workers)
+        w.join();
+    for (size_t t = 1; t < chunks.size(); t++)
+        close(chunks[t].fd);
+    close(outFd);
+    if (writeError != 0)
+    {
+        fprintf(stderr, "%s: %s\n", outPath, strerror(writeError));
+        return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    fprintf(stderr, "%zu rows (%zu skipped) in %.3f s with %u threads, %.1f MB/s in\n", rows, skipped, seconds,
+            threads, seconds > 0 ? size / seconds / 1e6 : 0.0);
+
+    if (data)
+        munmap((void *)data, size);
+    return 0;
+}
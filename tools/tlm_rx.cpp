@@ -0,0 +1,321 @@
+/*
+ * Telemetry receiver (host side)
+ *
+ * Reads the firmware's COBS framed binary telemetry from a capture file, a serial
+ * device or a pty, checks each frame's CRC and either prints CSV or live statistics.
+ * Bytes that are not valid frames (boot messages) are counted and skipped. Flight recorder
+ * dumps ('d' command, raw FREC blocks on the same port) are recognised by their header and
+ * skipped whole, so they don't show up as bad frames; decode them with fr_decode.
+ *
+ * Build: g++ -O2 -std=c++17 -o tlm_rx tools/tlm_rx.cpp
+ * Usage: ./tlm_rx [--stats] <capture.bin | /dev/ttyACM0 | -> [> out.csv]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include "../src/crc16.h"
+#include "../src/cobs.h"
+#include "../src/telemetry_format.h"
+#include "../src/flight_format.h"
+
+struct RxStats
+{
+    unsigned long frames = 0;
+    unsigned long badFrames = 0; // CRC, length or COBS errors
+    unsigned long seqGaps = 0;   // Frames lost between the board and us
+    unsigned long samples = 0;
+    unsigned long timings = 0;
+    unsigned long health = 0;
+    unsigned long dumps = 0;     // Flight recorder dumps skipped
+    int lastSeq = -1;
+    TelemetryTimings lastTimings = {};
+    TelemetryHealth lastHealth = {};
+};
+
+static bool statsMode = false;
+static RxStats stats;
+
+static void handleFrame(const uint8_t *frame, size_t len)
+{
+    if (len < sizeof(TelemetryHeader) + sizeof(uint16_t))
+    {
+        stats.badFrames++;
+        return;
+    }
+    uint16_t expected;
+    memcpy(&expected, frame + len - sizeof(expected), sizeof(expected));
+    if (crc16(frame, len - sizeof(expected)) != expected)
+    {
+        stats.badFrames++;
+        return;
+    }
+
+    TelemetryHeader header;
+    memcpy(&header, frame, sizeof(header));
+    const uint8_t *payload = frame + sizeof(header);
+    size_t payloadLen = len - sizeof(header) - sizeof(expected);
+
+    if (stats.lastSeq >= 0)
+        stats.seqGaps += (uint8_t)(header.seq - stats.lastSeq - 1);
+    stats.lastSeq = header.seq;
+    stats.frames++;
+
+    switch (header.type)
+    {
+    case TLM_SAMPLE:
+    {
+        // Sensor count follows from the payload length
+        size_t perSensor = payloadLen - TLM_SAMPLE_FIXED;
+        if (payloadLen < TLM_SAMPLE_FIXED || perSensor % sizeof(float) != 0 ||
+            perSensor / sizeof(float) > TLM_MAX_CHANNELS)
+            break;
+        size_t n = perSensor / sizeof(float);
+        TelemetrySampleN<TLM_MAX_CHANNELS> s;
+        float tail[3];
+        memcpy(&s.t_ms, payload, sizeof(s.t_ms));
+        memcpy(s.lux, payload + sizeof(s.t_ms), perSensor);
+        memcpy(tail, payload + sizeof(s.t_ms) + perSensor, sizeof(tail));
+        stats.samples++;
+        if (!statsMode)
+        {
+            printf("sample,%u", s.t_ms);
+            for (size_t i = 0; i < n; i++)
+                printf(",%.2f", s.lux[i]);
+            printf(",%.2f,%.2f,%.2f\n", tail[0], tail[1], tail[2]);
+        }
+        break;
+    }
+    case TLM_TIMINGS:
+    {
+        if (payloadLen != sizeof(TelemetryTimings))
+            break;
+        TelemetryTimings &t = stats.lastTimings;
+        memcpy(&t, payload, sizeof(t));
+        stats.timings++;
+        if (!statsMode)
+            printf("timings,%u,%u,%u,%u,%u,%u,%u,%u,%u\n", t.total, t.sensors, t.calcs, t.tempHum, t.display,
+                   t.sdFormat, t.sdWrite, t.sdLoop, t.uplink);
+        break;
+    }
+    case TLM_HEALTH:
+    {
+        if (payloadLen != sizeof(TelemetryHealth))
+            break;
+        TelemetryHealth &h = stats.lastHealth;
+        memcpy(&h, payload, sizeof(h));
+        stats.health++;
+        if (!statsMode)
+            printf("health,%u,%u,%u,%u,%u\n", h.uptime_ms, h.loops, h.framesSent, h.framesDropped, h.sdErrors);
+        break;
+    }
+    case TLM_MEMORY:
+    {
+        if (payloadLen != sizeof(TelemetryMemory))
+            break;
+        TelemetryMemory m;
+        memcpy(&m, payload, sizeof(m));
+        if (!statsMode)
+            printf("memory,%u,%u,%u,%u,%u,%u,%u\n", m.stackSize, m.stackHighWater, m.heapArena, m.heapUsed,
+                   m.heapFree, m.heapFreeBlocks, m.heapHeadroom);
+        else
+            fprintf(stderr, "memory: stack %u/%u | heap arena %u used %u free %u (%u blocks) headroom %u\n",
+                    m.stackHighWater, m.stackSize, m.heapArena, m.heapUsed, m.heapFree, m.heapFreeBlocks,
+                    m.heapHeadroom);
+        break;
+    }
+    default:
+        stats.badFrames++;
+        break;
+    }
+}
+
+static void printStats(double seconds)
+{
+    const TelemetryTimings &t = stats.lastTimings;
+    const TelemetryHealth &h = stats.lastHealth;
+    fprintf(stderr,
+            "frames %lu (bad %lu, lost %lu) | samples %.1f/s | loop %u us (sensors %u, calcs %u, display %u, sd %u, "
+            "uplink %u) "
+            "| board sent %u dropped %u sdErr %u | fr dumps %lu\n",
+            stats.frames, stats.badFrames, stats.seqGaps, seconds > 0 ? stats.samples / seconds : 0.0,
+            t.total, t.sensors, t.calcs, t.display, t.sdFormat + t.sdWrite + t.sdLoop, t.uplink,
+            h.framesSent, h.framesDropped, h.sdErrors, stats.dumps);
+}
+
+// Put a serial device into raw mode so bytes arrive untouched
+static void configureTty(int fd)
+{
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0)
+        return;
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B115200);
+    cfsetospeed(&tio, B115200);
+    tcsetattr(fd, TCSANOW, &tio);
+}
+
+// Skips a flight recorder dump in the byte stream: the "FREC" magic, the rest of the header,
+// then count * sampleSize bytes of samples and the CRC
+struct DumpSkipper
+{
+    uint32_t recent = 0;  // Last four bytes seen, for spotting the magic
+    bool active = false;
+    uint8_t header[sizeof(FlightDumpHeader)];
+    size_t headerLen = 0;
+    size_t remaining = 0; // Body bytes still to skip once the header is complete
+
+    // Feed one byte; true if it belonged to a dump (or completed the magic)
+    bool consume(uint8_t byte)
+    {
+        if (!active)
+        {
+            recent = (recent << 8) | byte;
+            if (recent != ('F' << 24 | 'R' << 16 | 'E' << 8 | 'C'))
+                return false;
+            memcpy(header, "FREC", 4);
+            headerLen = 4;
+            remaining = 0;
+            active = true;
+            return true;
+        }
+
+        if (headerLen < sizeof(header))
+        {
+            header[headerLen++] = byte;
+            if (headerLen == sizeof(header))
+            {
+                FlightDumpHeader h;
+                memcpy(&h, header, sizeof(h));
+                if (h.version != FR_DUMP_VERSION || h.channels == 0 ||
+                    h.sampleSize != flightSampleSize(h.channels))
+                {
+                    // Not a dump after all; the caller resynchronises at the next delimiter
+                    active = false;
+                    recent = 0;
+                    return false;
+                }
+                remaining = (size_t)h.count * h.sampleSize + sizeof(uint16_t);
+                stats.dumps++;
+            }
+            return true;
+        }
+
+        if (--remaining == 0)
+        {
+            active = false;
+            recent = 0;
+        }
+        return true;
+    }
+};
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--stats") == 0)
+            statsMode = true;
+        else
+            path = argv[i];
+    }
+    if (!path)
+    {
+        fprintf(stderr, "usage: %s [--stats] <file|device|->\n", argv[0]);
+        return 1;
+    }
+
+    int fd = strcmp(path, "-") == 0 ? STDIN_FILENO : open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0)
+    {
+        perror(path);
+        return 1;
+    }
+    if (isatty(fd))
+        configureTty(fd);
+
+    if (!statsMode)
+    {
+        printf("# sample,t_ms,lux1..luxN,angle,temp,humidity\n");
+        printf("# timings,total,sensors,calcs,temphum,display,sdformat,sdwrite,sdloop,uplink\n");
+        printf("# health,uptime_ms,loops,frames_sent,frames_dropped,sd_errors\n");
+        printf("# memory,stack_size,stack_high_water,heap_arena,heap_used,heap_free,heap_free_blocks,heap_headroom\n");
+    }
+
+    uint8_t encoded[TLM_MAX_ENCODED];
+    uint8_t frame[TLM_MAX_ENCODED];
+    size_t encodedLen = 0;
+    bool overflow = false;
+    DumpSkipper dump;
+
+    double start = now();
+    double lastReport = start;
+    uint8_t chunk[4096];
+    ssize_t n;
+    while ((n = read(fd, chunk, sizeof(chunk))) > 0)
+    {
+        for (ssize_t i = 0; i < n; i++)
+        {
+            bool wasActive = dump.active;
+            if (dump.consume(chunk[i]))
+            {
+                // "FRE" already went into the frame buffer; the partial frame is the dump's start
+                if (!wasActive)
+                {
+                    encodedLen = 0;
+                    overflow = false;
+                }
+                continue;
+            }
+            if (wasActive)
+            {
+                // Header didn't check out: drop what we have and wait for a delimiter
+                encodedLen = 0;
+                overflow = true;
+            }
+
+            if (chunk[i] != 0)
+            {
+                // Anything longer than the largest frame is noise; drop it at the next delimiter
+                if (encodedLen < sizeof(encoded))
+                    encoded[encodedLen++] = chunk[i];
+                else
+                    overflow = true;
+                continue;
+            }
+
+            if (overflow)
+                stats.badFrames++;
+            else if (encodedLen > 0)
+            {
+                size_t len = cobsDecode(encoded, encodedLen, frame);
+                if (len)
+                    handleFrame(frame, len);
+                else
+                    stats.badFrames++;
+            }
+            encodedLen = 0;
+            overflow = false;
+        }
+
+        if (statsMode && now() - lastReport >= 1.0)
+        {
+            printStats(now() - start);
+            lastReport = now();
+        }
+    }
+
+    printStats(now() - start);
+    return 0;
+}
@@ -0,0 +1,349 @@
+/*
+ * Network uplink receiver and board stand-in (host side)
+ *
+ * Receive mode listens for the firmware's UDP batches, checks each CRC, and prints the
+ * samples as CSV or live stats. The stats separate network loss (sequence gaps) from
+ * batches the board dropped itself (counter carried in every header). Duplicate batches are
+ * counted and discarded. A sequence number far behind the last one, a repeat of batch 0, or a
+ * drop counter that went down means the board restarted, and both counts start again from there.
+ *
+ * Simulate mode plays the board: it sends synthetic batches in the same format, optionally
+ * skipping some to emulate network loss (sequence number used, datagram never sent) or board
+ * drops (no sequence number, counted in droppedBatches like a full queue on the board). This
+ * tests the receiver's loss accounting and the batch/rate settings without hardware.
+ *
+ * Build: g++ -O2 -std=c++17 -o uplink_rx tools/uplink_rx.cpp
+ * Usage: ./uplink_rx [--stats] [--idle-exit S] [port]
+ *        ./uplink_rx --simulate <host> <port> [--batch N] [--rate HZ] [--batches N] [--lose-every K]
+ *                    [--board-drop-every K]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <vector>
+#include "../src/crc16.h"
+#include "../src/telemetry_format.h"
+#include "../src/uplink_format.h"
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Batches that many sequence numbers late are taken as a board restart (sequence back near 0)
+const uint32_t SEQ_WINDOW = 64;
+
+struct UplinkStats
+{
+    unsigned long batches = 0;
+    unsigned long samples = 0;
+    unsigned long bad = 0;        // Wrong magic/version/size/CRC
+    unsigned long lost = 0;       // Sequence gaps not filled in later
+    unsigned long reordered = 0;  // Filled a gap after a later batch arrived
+    unsigned long duplicates = 0; // Sequence number already received
+    unsigned long restarts = 0;   // Board restarts seen (sequence started again)
+    unsigned long boardDropped = 0;  // Board-side drops, summed over restarts
+    uint32_t boardDroppedBoot = 0;   // Board's own counter since its last restart
+    int64_t nextSeq = -1;
+    uint64_t seen = 0;    // Bit i set: batch nextSeq - 1 - i was received
+    uint64_t missing = 0; // Bit i set: batch nextSeq - 1 - i was counted as lost
+};
+
+// Account for one batch's sequence number and drop counter; false for a duplicate
+static bool trackSequence(UplinkStats &s, const UplinkHeader &header)
+{
+    int64_t seq = header.seq;
+    uint64_t bit = s.nextSeq > seq && s.nextSeq - seq <= (int64_t)SEQ_WINDOW ? 1ULL << (s.nextSeq - 1 - seq) : 0;
+    if (s.nextSeq >= 0 && ((seq < s.nextSeq && !bit) || (seq == 0 && (s.seen & bit)) ||
+                           header.droppedBatches < s.boardDroppedBoot))
+    {
+        // Restarted: keep what the old boot dropped and track the new sequence from here
+        s.restarts++;
+        s.nextSeq = -1;
+        s.boardDroppedBoot = 0;
+    }
+
+    if (s.nextSeq >= 0 && seq < s.nextSeq)
+    {
+        if (s.seen & bit)
+        {
+            s.duplicates++;
+            return false;
+        }
+        s.seen |= bit;
+        s.reordered++;
+        if (s.missing & bit)
+        {
+            // Counted as lost when the gap was seen; take it back
+            s.missing &= ~bit;
+            s.lost--;
+        }
+    }
+    else
+    {
+        int64_t gap = s.nextSeq >= 0 ? seq - s.nextSeq : 0;
+        s.lost += gap;
+        if (s.nextSeq < 0)
+        {
+            s.seen = 1;
+            s.missing = 0;
+        }
+        else if (gap + 1 >= 64)
+        {
+            s.seen = 1;
+            s.missing = ~1ULL;
+        }
+        else
+        {
+            s.seen = (s.seen << (gap + 1)) | 1;
+            s.missing = (s.missing << (gap + 1)) | (((1ULL << gap) - 1) << 1);
+        }
+        s.nextSeq = seq + 1;
+    }
+
+    s.boardDropped += header.droppedBatches - s.boardDroppedBoot;
+    s.boardDroppedBoot = header.droppedBatches;
+    return true;
+}
+
+static void printStats(const UplinkStats &s, double seconds)
+{
+    unsigned long expected = s.batches + s.lost;
+    fprintf(stderr, "batches %lu | samples %lu (%.1f/s) | network lost %lu (%.2f%%) reordered %lu duplicates %lu | "
+                    "board dropped %lu restarts %lu | bad %lu\n",
+            s.batches, s.samples, seconds > 0 ? s.samples / seconds : 0.0, s.lost,
+            expected ? 100.0 * s.lost / expected : 0.0, s.reordered, s.duplicates, s.boardDropped, s.restarts,
+            s.bad);
+}
+
+static int receive(int port, bool statsMode, double idleExit)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (sock < 0 || bind(sock, (sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        perror("bind");
+        return 1;
+    }
+    struct timeval tv = {0, 200000}; // Wake up regularly for stats and the idle check
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    fprintf(stderr, "listening on UDP port %d\n", port);
+    if (!statsMode)
+        printf("seq,t_ms,lux1..luxN,angle,temp,humidity\n");
+
+    UplinkStats stats;
+    uint8_t buf[65536];
+    double start = 0, lastPacket = now(), lastReport = now();
+
+    while (true)
+    {
+        ssize_t len = recv(sock, buf, sizeof(buf), 0);
+        double t = now();
+        if (statsMode && t - lastReport >= 1.0)
+        {
+            printStats(stats, start ? t - start : 0);
+            lastReport = t;
+        }
+        if (len < 0)
+        {
+            if (idleExit > 0 && t - lastPacket > idleExit)
+                break;
+            continue;
+        }
+        lastPacket = t;
+        if (!start)
+            start = t;
+
+        UplinkHeader header;
+        if ((size_t)len < sizeof(header) + sizeof(uint16_t))
+        {
+            stats.bad++;
+            continue;
+        }
+        memcpy(&header, buf, sizeof(header));
+        size_t body = (size_t)header.count * header.sampleSize;
+        uint16_t crc;
+        if (memcmp(header.magic, "LTUP", 4) != 0 || header.version != UPLINK_VERSION ||
+            header.sampleSize != TLM_SAMPLE_FIXED + header.channels * sizeof(float) ||
+            header.channels > TLM_MAX_CHANNELS || sizeof(header) + body + sizeof(crc) != (size_t)len)
+        {
+            stats.bad++;
+            continue;
+        }
+        memcpy(&crc, buf + sizeof(header) + body, sizeof(crc));
+        if (crc16(buf, sizeof(header) + body) != crc)
+        {
+            stats.bad++;
+            continue;
+        }
+
+        if (!trackSequence(stats, header))
+            continue;
+        stats.batches++;
+        stats.samples += header.count;
+
+        if (!statsMode)
+        {
+            for (uint16_t i = 0; i < header.count; i++)
+            {
+                const uint8_t *s = buf + sizeof(header) + i * header.sampleSize;
+                uint32_t t_ms;
+                float values[TLM_MAX_CHANNELS + 3];
+                memcpy(&t_ms, s, sizeof(t_ms));
+                memcpy(values, s + sizeof(t_ms), header.sampleSize - sizeof(t_ms));
+                printf("%u,%u", header.seq, t_ms);
+                for (int v = 0; v < header.channels + 3; v++)
+                    printf(",%.2f", values[v]);
+                printf("\n");
+            }
+        }
+    }
+
+    printStats(stats, start ? lastPacket - start : 0);
+    close(sock);
+    return 0;
+}
+
+static int simulate(const char *host, int port, int batchSize, double rate, long batches, int loseEvery,
+                    int boardDropEvery)
+{
+    const uint8_t channels = 3;
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (sock < 0 || inet_pton(AF_INET, host, &addr.sin_addr) != 1)
+    {
+        fprintf(stderr, "bad host %s\n", host);
+        return 1;
+    }
+
+    typedef TelemetrySampleN<channels> Sample;
+    if (sizeof(UplinkHeader) + batchSize * sizeof(Sample) + sizeof(uint16_t) > UPLINK_MAX_DATAGRAM)
+    {
+        fprintf(stderr, "batch of %d samples exceeds %u bytes\n", batchSize, UPLINK_MAX_DATAGRAM);
+        return 1;
+    }
+
+    std::vector<uint8_t> datagram(UPLINK_MAX_DATAGRAM);
+    double interval = batchSize / rate; // Seconds per batch at the given sample rate
+    double next = now();
+    uint32_t t_ms = 0, seq = 0, boardDropped = 0;
+    unsigned long sent = 0, skipped = 0;
+
+    for (long b = 0; batches <= 0 || b < batches; b++)
+    {
+        bool boardDrop = boardDropEvery > 0 && (b + 1) % boardDropEvery == 0;
+
+        UplinkHeader header;
+        memcpy(header.magic, "LTUP", 4);
+        header.version = UPLINK_VERSION;
+        header.channels = channels;
+        header.count = batchSize;
+        header.sampleSize = sizeof(Sample);
+        header.reserved = 0;
+        header.seq = seq;
+        header.droppedBatches = boardDropped;
+
+        uint8_t *p = datagram.data();
+        memcpy(p, &header, sizeof(header));
+        p += sizeof(header);
+        for (int i = 0; i < batchSize; i++, t_ms += (uint32_t)(1000 / rate))
+        {
+            // A light source circling the array
+            Sample s;
+            double phase = t_ms / 1000.0;
+            s.t_ms = t_ms;
+            for (int c = 0; c < channels; c++)
+                s.lux[c] = 500 + 200 * cos(phase - c * 2.0944);
+            s.angle = fmod(phase * 57.2958, 360.0) - 180;
+            s.temp = 25;
+            s.humidity = 50;
+            memcpy(p, &s, sizeof(s));
+            p += sizeof(s);
+        }
+        uint16_t crc = crc16(datagram.data(), p - datagram.data());
+        memcpy(p, &crc, sizeof(crc));
+        p += sizeof(crc);
+
+        if (boardDrop)
+            boardDropped++; // Emulated full queue on the board: no datagram, no sequence number
+        else if (seq++, loseEvery > 0 && (b + 1) % loseEvery == 0)
+            skipped++; // Emulated network loss
+        else if (sendto(sock, datagram.data(), p - datagram.data(), 0, (sockaddr *)&addr, sizeof(addr)) > 0)
+            sent++;
+
+        next += interval;
+        double wait = next - now();
+        if (wait > 0)
+            usleep((useconds_t)(wait * 1e6));
+    }
+
+    fprintf(stderr, "simulated %lu batches sent, %lu deliberately lost, %u dropped on the board\n", sent, skipped,
+            boardDropped);
+    close(sock);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    bool statsMode = false, simulateMode = false;
+    double idleExit = 0, rate = 50;
+    int port = 5005, batch = 16, loseEvery = 0, boardDropEvery = 0;
+    long batches = 0;
+    const char *host = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--stats") == 0)
+            statsMode = true;
+        else if (strcmp(argv[i], "--idle-exit") == 0 && i + 1 < argc)
+            idleExit = atof(argv[++i]);
+        else if (strcmp(argv[i], "--simulate") == 0 && i + 2 < argc)
+        {
+            simulateMode = true;
+            host = argv[++i];
+            port = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc)
+            batch = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc)
+            rate = atof(argv[++i]);
+        else if (strcmp(argv[i], "--batches") == 0 && i + 1 < argc)
+            batches = atol(argv[++i]);
+        else if (strcmp(argv[i], "--lose-every") == 0 && i + 1 < argc)
+            loseEvery = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--board-drop-every") == 0 && i + 1 < argc)
+            boardDropEvery = atoi(argv[++i]);
+        else if (argv[i][0] != '-')
+            port = atoi(argv[i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [--stats] [--idle-exit S] [port]\n"
+                            "       %s --simulate <host> <port> [--batch N] [--rate HZ] [--batches N] [--lose-every K]\n"
+                            "                   [--board-drop-every K]\n",
+                    argv[0], argv[0]);
+            return 1;
+        }
+    }
+
+    if (batch < 1 || rate <= 0)
+    {
+        fprintf(stderr, "batch and rate must be positive\n");
+        return 1;
+    }
+    return simulateMode ? simulate(host, port, batch, rate, batches, loseEvery, boardDropEvery) : receive(port, statsMode, idleExit);
+}